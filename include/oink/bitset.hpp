@@ -153,6 +153,20 @@ public:
         return _size;
     }
 
+    /**
+     * Direct access to the blocks of 64 bits, e.g., for reading or writing the bitset to a file.
+     * There are (size()+63)/64 blocks; the unused bits of the last block must be zero.
+     */
+    inline uint64_t* data(void)
+    {
+        return _bits;
+    }
+
+    inline const uint64_t* data(void) const
+    {
+        return _bits;
+    }
+
     std::size_t count(void) const
     {
         return popcnt(_bits, num_blocks()*8);
@@ -216,6 +230,25 @@ public:
         return (_bits[block_index(pos)] & bit_mask(pos)) != 0;
     }
 
+    /**
+     * Test the bit at <pos> with an atomic load.
+     * (Safe when other threads set bits in the same block with atomic_set.)
+     */
+    inline bool atomic_test(size_t pos) const
+    {
+        return (__atomic_load_n(&_bits[block_index(pos)], __ATOMIC_RELAXED) & bit_mask(pos)) != 0;
+    }
+
+    /**
+     * Atomically set the bit at <pos>, returns whether the bit was already set.
+     * (Safe when multiple threads set bits in the same block.)
+     */
+    inline bool atomic_set(size_t pos)
+    {
+        const uint64_t mask = bit_mask(pos);
+        return (__atomic_fetch_or(&_bits[block_index(pos)], mask, __ATOMIC_SEQ_CST) & mask) != 0;
+    }
+
     reference operator[](size_t pos)
     {
         return reference(_bits[block_index(pos)], bit_index(pos));
@@ -18,7 +18,11 @@
 #define GAME_HPP
 
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
@@ -26,13 +30,49 @@
 #include <boost/random/uniform_int_distribution.hpp>
 
 #include <oink/bitset.hpp>
+#include <oink/mappedfile.hpp>
 
 namespace pg {
 
+/**
+ * The type of positions in the edge arrays, i.e., the first outgoing and incoming edge of each vertex.
+ * By default this is int, which limits games to about 2^31 edges. Building with OINK_64BIT_EDGES makes
+ * this int64_t for games with billions of edges, at the cost of 8 more bytes per vertex.
+ * Vertices and everything indexed by vertex are always int.
+ */
+#ifdef OINK_64BIT_EDGES
+typedef int64_t edge_t;
+#else
+typedef int edge_t;
+#endif
+
+/**
+ * The successors or predecessors of a vertex as a range [begin, end), for range-based for loops.
+ * The length is known before the loop, unlike when scanning for the -1 terminator,
+ * so the compiler can vectorize loops that check or count the edges.
+ */
+class edge_range
+{
+public:
+    edge_range(const int *first, long count) : first(first), last(first + count) { }
+
+    inline const int *begin() const { return first; }
+    inline const int *end() const { return last; }
+    inline long size() const { return last - first; }
+    inline bool empty() const { return first == last; }
+
+private:
+    const int *first;
+    const int *last;
+};
+
 /**
  * The main class holding a Parity game.
  *
  * Edges are stored consecutively in a single array, ending with the value -1.
+ * The -1 terminators are part of the layout: outs/ins, most solvers and the .pgb format rely on them.
+ * The methods succs and preds give the edges of a vertex as a range without the -1 (using the counts),
+ * for loops that benefit from knowing the length; there is no separate layout without terminators.
  * For game solving, the build_in_array method creates the reverse array.
  *
  * There is a special vector representation of edges to allow for "random-order" modification
@@ -41,6 +81,8 @@ namespace pg {
  * - vec_add_edge, vec_remove_edge, vec_has_edge to manipulate the edges
  * - vec_finish() rebuilds the array representation
  *
+ * For making large games, GameBuilder (see gamebuilder.hpp) is much faster than the vector representation.
+ *
  * Usage scenario for making a game (random order):
  * - initialize with constructor Game(count) or using init_game(count)
  * - use vec_init
@@ -69,14 +111,15 @@ public:
     /**
      * Construct a new parity game for <count> vertices.
      */
-    Game(int count, int ecount = -1);
+    Game(int count, long ecount = -1);
 
     Game(size_t nv, size_t ne, std::vector<int>& priorities, bitset& owners, std::vector<std::vector<int>>& edges, std::vector<std::string*>& labels);
 
     /**
-     * Construct a deep clone of an existing parity game.
+     * Construct a copy of an existing parity game.
+     * The copy shares the priorities, labels, edges and in-edges with <other> until either game
+     * modifies them (copy on write). The owners and the solution are copied.
      * Does not clone the vector representation.
-     * Does not clone the <in> array.
      */
     Game(const Game& other);
 
@@ -136,14 +179,41 @@ public:
 
     /**
      * Check if a certain edge exists.
+     * Uses the self-loop flags (see build_selfloops) if from == to, and binary search if the successors are sorted.
      */
     bool has_edge(int from, int to);
 
     /**
      * Get the index of an edge in the edge array (or -1 if not found)
-     * NOTE: uses the edge arrays.
+     * NOTE: uses the edge arrays, with binary search if the successors are sorted.
+     */
+    edge_t find_edge(int from, int to);
+
+    /**
+     * Check if vertex <v> has a self-loop, in constant time if the self-loop flags are built.
+     */
+    inline bool has_selfloop(int v)
+    {
+        return selfloops_built ? (bool)_selfloop[v] : find_edge(v, v) != -1;
+    }
+
+    /**
+     * Build the self-loop flags of all vertices (unless they are already built).
+     * The flags are kept by sort and permute, and discarded when the edges are modified.
+     */
+    void build_selfloops(void);
+
+    /**
+     * Sort the successors of every vertex (unless they are already sorted), so edge lookups use binary search.
+     * The successors stay sorted by sort and permute, until the edges are modified.
+     * Games made by GameBuilder and read from .pgc files have sorted successors.
+     */
+    void sort_succs(void);
+
+    /**
+     * Check if the successors of every vertex are sorted.
      */
-    int find_edge(int from, int to);
+    inline bool succs_sorted(void) const { return sorted_succs; }
 
     /**
      * Parse a [full or partial] pgsolver solution.
@@ -155,6 +225,20 @@ public:
      */
     void write_pgsolver(std::ostream &out);
 
+    /**
+     * Write the game in the binary .pgb format to the stream <out>.
+     * The in-edges are included if they have been built (see build_in_array).
+     * Such a file is loaded by PGParser::parse_binary_file without parsing.
+     */
+    void write_binary(std::ostream &out);
+
+    /**
+     * Write the game in the compact .pgc format to the stream <out>.
+     * Successor lists are sorted and delta-encoded, priorities are run-length encoded.
+     * Such a file is read by PGParser::parse_compact.
+     */
+    void write_compact(std::ostream &out);
+
     /**
      * Write the game as a DOT graph to the stream <out>.
      */
@@ -169,6 +253,8 @@ public:
      * Sort the vertices in order of priority (low to high).
      * If <mapping> is given as an int array of size vertexcount(),
      * then it can be used with permute to reverse the procedure.
+     * The sort is stable: vertices with the same priority keep their order, so the <mapping> does not depend
+     * on whether the sort runs in parallel. For large games, if Lace is running, this uses a parallel radix sort.
      */
     void sort(int *mapping = NULL);
 
@@ -180,6 +266,7 @@ public:
     /**
      * Apply a permutation, moving each vertex <i> to position <mapping[i]>.
      * Afterwards, <is_ordered> is updated.
+     * For large games, if Lace is running, the arrays are permuted out-of-place in parallel.
      */
     void permute(int *mapping); // undo reindex
 
@@ -216,8 +303,34 @@ public:
      */
     void minmax(void);
 
+    /**
+     * Methods for reorder.
+     */
+    enum reorder_method {
+        REORDER_BFS,    // breadth-first over the in-edges, from the vertices with the highest priority
+        REORDER_RCM     // reverse Cuthill-McKee over the in-edges (neighbours with lowest degree first)
+    };
+
+    /**
+     * Reorder the vertices within every block of equal priority, to improve the locality of attractor
+     * computations: vertices that are close in the (in-edge) graph get nearby positions.
+     * The vertices stay in order of priority. Builds the <in> array if needed.
+     * If <mapping> is given (as from sort), it is updated so permute still restores the original order.
+     * (Only valid if vertices are ordered.)
+     */
+    void reorder(reorder_method method, int *mapping = NULL);
+
+    /**
+     * Reordering (sort, permute, sort_succs, build_selfloops, build_in_array and load_edges) runs in parallel
+     * if Lace is running and the game has at least <vertices> vertices (default 2^16).
+     * Tests set this to 0 to run the parallel code on small games, or to SIZE_MAX to run the sequential code.
+     */
+    static void set_parallel_reorder(size_t vertices);
+    static size_t get_parallel_reorder(void);
+
     /**
      * (re)build the <in> array for PG solving.
+     * For large games, if Lace is running, this runs in parallel.
      */
     void build_in_array(bool rebuild=false);
 
@@ -288,6 +401,11 @@ public:
      */
     Game &operator=(const Game &other);
 
+    /**
+     * Move the game.
+     */
+    Game &operator=(Game &&other) noexcept;
+
     /**
      * Swap with other game.
      */
@@ -309,6 +427,14 @@ public:
         return _owner[vertex];
     }
 
+    /**
+     * Get the priority array (until the priorities are modified)
+     */
+    inline const int* priorities() const
+    {
+        return _priority;
+    }
+
     /**
      * Get the owner bitset
      */
@@ -318,11 +444,22 @@ public:
     }
 
     /**
-     * Get the "real" label of a vertex
+     * Get the "real" label of a vertex (empty if the vertex has no label)
+     * The view is valid until the labels of the game are modified.
+     */
+    inline std::string_view rawlabel(const int vertex) const
+    {
+        const uint64_t ref = _label[vertex];
+        if (ref == 0) return std::string_view();
+        return std::string_view(label_data() + (ref >> LABEL_LENGTH_BITS), ref & LABEL_LENGTH_MASK);
+    }
+
+    /**
+     * Returns false if no vertex has a label (vertices can still have empty labels otherwise)
      */
-    inline std::string* rawlabel(const int vertex) const
+    inline bool has_labels() const
     {
-        return _label[vertex];
+        return _label_arena != nullptr or _label_file != nullptr;
     }
 
     /**
@@ -339,12 +476,12 @@ public:
         return _inedges;
     }
 
-    inline int firstout(const int vertex) const
+    inline edge_t firstout(const int vertex) const
     {
         return _firstouts[vertex];
     }
 
-    inline int firstin(const int vertex) const
+    inline edge_t firstin(const int vertex) const
     {
         return _firstins[vertex];
     }
@@ -369,6 +506,19 @@ public:
         return inedges() + firstin(vertex);
     }
 
+    /**
+     * The successors/predecessors of a vertex as a range, without the -1 terminator.
+     */
+    inline edge_range succs(const int vertex) const
+    {
+        return edge_range(outs(vertex), _outcount[vertex]);
+    }
+
+    inline edge_range preds(const int vertex) const
+    {
+        return edge_range(ins(vertex), _incount[vertex]);
+    }
+
     inline const std::vector<int> outvec(const int vertex) const
     {
         return _outvec[vertex];
@@ -449,9 +599,9 @@ public:
             if (lv.v < 0 or lv.v >= lv.g.nodecount()) {
                 out << "<N/A>";
             } else {
-                std::string* l = lv.g.rawlabel(lv.v);
-                if (l == nullptr or l->empty()) out << lv.v << "/" << lv.g.priority(lv.v);
-                else out << *l;
+                std::string_view l = lv.g.rawlabel(lv.v);
+                if (l.empty()) out << lv.v << "/" << lv.g.priority(lv.v);
+                else out << l;
             }
             return out;
         }
@@ -479,33 +629,175 @@ private:
     long n_edges;           // number of edges
     int *_priority;        // priority of each vertex
     bitset _owner;         // owner of each vertex (1 for odd, 0 for even)
-    std::string **_label;  // (optional) vertex labels
+    uint64_t *_label;      // (optional) vertex labels, see label_ref
 
     int *_outedges;        // outgoing edges as array
-    int *_firstouts;       // first outgoing edge of each vertex
+    edge_t *_firstouts;    // first outgoing edge of each vertex
     int *_outcount;        // outgoing edge count of each vertex
 
     int *_inedges;         // incoming edges as array
-    int *_firstins;        // first incoming edge of each vertex
+    edge_t *_firstins;     // first incoming edge of each vertex
     int *_incount;         // incoming edge count of each vertex
 
     std::vector<int> *_outvec; // outgoing edges as vector
 
     bool is_ordered;       // records if the game is in-order
+    bool sorted_succs;     // records if the successors of every vertex are sorted
+    bool selfloops_built;  // records if _selfloop is built
+    bitset _selfloop;      // (optional) self-loop flag of each vertex
     size_t v_allocated;    // number of vertices allocated as virtual memory
     size_t e_allocated;    // number of edges allocated as virtual memory
     size_t e_size;         // number of entries used in edge array
 
+    // the highest position in the edge arrays
+    static constexpr size_t EDGE_OFFSET_MAX = std::numeric_limits<edge_t>::max();
+
     bitset solved;         // set true if vertex solved
     bitset winner;         // for solved vertices, set 1 if won by 1, else 0
     int *strategy;         // strategy for winning vertices
 
     void unsafe_permute(int *mapping); // apply a reordering
+    void permute_par(const int *mapping); // apply a reordering out-of-place using the Lace workers
+    void build_in_array_par(void); // build the <in> array using the Lace workers
+
+    /**
+     * The arrays of a game loaded from a .pgb file point into a private writable mapping of the file.
+     * Modifying the arrays in place (sort, permute, renumber, ...) is fine; the kernel then copies the
+     * modified pages. Before reallocating or freeing an array, we must check whether it is mapped.
+     */
+    std::shared_ptr<MappedFile> _mapped; // (optional) the mapping that arrays can point into
+
+    inline bool is_mapped(const void *ptr) const { return _mapped and _mapped->contains(ptr); }
+    void unmap(void); // copy all mapped and shared arrays to owned memory and release the mapping
+
+    /**
+     * Copies of a game share the arrays of the topology (priorities, labels, edges and in-edges) until one
+     * of the games modifies them (copy on write). The shared arrays are registered in a shared_arrays object,
+     * with the number of games that use each array; an array is freed (unless it is mapped) by the last
+     * game that uses it. Every game records in _sharing which of its arrays are shared, so checking whether
+     * an array is shared never locks, and _shared is released when none of the arrays are shared anymore.
+     * Before modifying a shared array in place, unshare it; before reallocating arrays, call unmap;
+     * to stop using an array, call release_array.
+     *
+     * Thread safety: copying a game only reads the game, except that share() registers its arrays in _shared.
+     * All access to the shared_arrays objects (and the creation of _shared) is guarded by a single mutex,
+     * so several threads may copy the same (const) game concurrently, and games that share arrays may be
+     * modified concurrently. As usual, a game must not be modified while another thread reads or copies it.
+     * The mutex is only taken when copying a game and when a game stops using a shared array.
+     */
+    struct shared_arrays
+    {
+        std::shared_ptr<MappedFile> mapped;         // the mapping that shared arrays can point into
+        std::vector<std::pair<void*, int>> arrays;  // the shared arrays, with the number of games that use them
+
+        ~shared_arrays();
+        void drop(void *arr); // one game less uses <arr>; frees it if it was the last
+    };
+
+    static const int TOPOLOGY_ARRAYS = 8; // priorities, labels, firstouts, outcount, outedges, inedges, firstins, incount
+
+    mutable std::shared_ptr<shared_arrays> _shared; // (optional) the arrays shared with copies of this game
+    mutable void *_sharing[TOPOLOGY_ARRAYS] = {};   // the arrays of this game that are registered in _shared
+
+    inline bool is_shared(const void *ptr) const
+    {
+        if (!_shared or ptr == NULL) return false;
+        for (const void *arr : _sharing) {
+            if (arr == ptr) return true;
+        }
+        return false;
+    }
+    void share(Game &copy) const; // register the arrays in _shared, and let <copy> use them
+    template <typename T> void unshare(T *&arr, size_t len); // ensure that <arr> (of <len> elements) is not shared
+    void unshare(void); // ensure that no array is shared
+    void release_array(void *arr); // stop using <arr>: free it, unless it is mapped or still used by a copy
+    void forget_shared(const void *arr); // remove <arr> from _sharing, and release _shared if it is empty
+
+    /**
+     * All labels are stored in a single arena: either a string owned by the game, or the mapped input file.
+     * The arena is shared by copies of the game and never modified while shared (copy on write).
+     * For every vertex, _label has the offset of the label in the arena and its length, or 0 if there is no label.
+     */
+    std::shared_ptr<std::string> _label_arena; // the owned label arena
+    std::shared_ptr<MappedFile> _label_file;   // or: the mapped file that contains the labels
+
+    static constexpr int LABEL_LENGTH_BITS = 24;
+    static constexpr uint64_t LABEL_LENGTH_MASK = (uint64_t(1) << LABEL_LENGTH_BITS) - 1;
+
+    static inline uint64_t label_ref(size_t offset, size_t length)
+    {
+        if (length > LABEL_LENGTH_MASK or offset >= (uint64_t(1) << (64-LABEL_LENGTH_BITS))) throw std::runtime_error("label too long");
+        return length == 0 ? 0 : (uint64_t(offset) << LABEL_LENGTH_BITS) | length;
+    }
+
+    inline const char* label_data() const
+    {
+        return _label_file ? _label_file->data() : _label_arena->data();
+    }
+
+    void own_labels(void); // ensure that the label arena is owned and not shared
+
+    /**
+     * The header of the binary .pgb format. Sections follow the header in this order, each at
+     * an offset that is a multiple of 64 bytes:
+     * - priorities (int[n_vertices])
+     * - owners (uint64_t[(n_vertices+63)/64], the words of the bitset)
+     * - firstouts (int[n_vertices], or int64_t[n_vertices] if FLAG_EDGE64) and outcount (int[n_vertices])
+     * - outedges (int[e_size], every successor list ends with -1)
+     * - if FLAG_INEDGES: firstins (as firstouts) and incount (int[n_vertices]), inedges (int[n_vertices+n_edges])
+     * - if FLAG_LABELS: label offsets (uint64_t[n_vertices+1]) into the label blob (char[label_size])
+     */
+    struct binary_header
+    {
+        static constexpr char MAGIC[8] = { 'O', 'I', 'N', 'K', 'P', 'G', 'B', '\0' };
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t ENDIAN = 0x01020304;
+        static constexpr uint32_t FLAG_ORDERED = 1;
+        static constexpr uint32_t FLAG_INEDGES = 2;
+        static constexpr uint32_t FLAG_LABELS = 4;
+        static constexpr uint32_t FLAG_EDGE64 = 8;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t n_vertices;
+        uint64_t n_edges;
+        uint64_t e_size;
+        uint64_t label_size;
+    };
     
+    /**
+     * The compact .pgc format is a stream of unsigned LEB128 varints, signed values are zigzag encoded:
+     * - magic (8 bytes), version, flags, n_vertices, n_edges
+     * - priorities as runs: zigzag(priority - previous priority), run length
+     * - owners: (n_vertices+7)/8 bytes, vertex i is bit (i%8) of byte i/8
+     * - for each vertex v: the number of successors, then the sorted successors,
+     *   the first as zigzag(successor - v), the others as difference with the previous successor
+     * - if FLAG_LABELS: for each vertex the length of the label, then the label
+     */
+    struct compact_format
+    {
+        static constexpr char MAGIC[8] = { 'O', 'I', 'N', 'K', 'P', 'G', 'C', '\0' };
+        static constexpr uint64_t VERSION = 1;
+        static constexpr uint64_t FLAG_LABELS = 1;
+    };
+
     boost::random::mt19937 generator;
     inline long rng(long low, long high) { return boost::random::uniform_int_distribution<> (low, high)(generator); }
 
+    /**
+     * Replace the edges by the <count> edges in <pairs>, every edge as (source << 32 | target).
+     * The pairs are sorted (in parallel for large games) and duplicate edges are removed, so the
+     * successors of every vertex are in ascending order. Also builds the self-loop flags.
+     * The array <pairs> is overwritten.
+     * Requires that the edge array has space for n_vertices+count+1 entries.
+     */
+    void load_edges(uint64_t *pairs, size_t count);
+
     friend class PGParser;
+    friend class GameBuilder;
 };
 
 }
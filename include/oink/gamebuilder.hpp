@@ -0,0 +1,105 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GAMEBUILDER_HPP
+#define GAMEBUILDER_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <oink/game.hpp>
+
+namespace pg {
+
+/**
+ * Build a parity game from vertices and edges that are added in any order.
+ *
+ * Edges are appended to a flat buffer of (source, target) pairs, without checking for duplicates.
+ * The method finish then sorts the buffer (in parallel if Lace is running), removes duplicate edges,
+ * and writes the edge arrays of the game in one pass. The successors of every vertex are in
+ * ascending order. This is much faster than the vector representation of Game (vec_init,
+ * vec_add_edge, vec_finish) for making large games.
+ *
+ * Usage scenario:
+ * - construct a builder, optionally with the expected number of vertices and edges
+ * - use init_vertex and add_edge (or add_edges) in any order
+ * - use finish to obtain the game
+ * Vertices that are not initialized with init_vertex have priority 0, owner Even and no label.
+ */
+class GameBuilder
+{
+public:
+    /**
+     * Construct a builder for (at least) <count> vertices, reserving space for <ecount> edges.
+     */
+    GameBuilder(int count = 0, size_t ecount = 0);
+
+    /**
+     * Initialize a vertex <v> with given <priority>, <owner> and <label>.
+     * The game has at least v+1 vertices.
+     */
+    void init_vertex(int v, int priority, int owner, const std::string &label="");
+
+    /**
+     * Add the edge from <from> to <to>. Both vertices must be in the game when finish is called.
+     */
+    inline void add_edge(int from, int to)
+    {
+        assert(from >= 0 and to >= 0);
+        edges.push_back((uint64_t)from << 32 | (uint32_t)to);
+    }
+
+    /**
+     * Add the <count> edges from <from>[i] to <to>[i].
+     */
+    void add_edges(const int *from, const int *to, size_t count);
+
+    /**
+     * Add the <count> edges from <from> to <to>[i].
+     */
+    void add_edges(int from, const int *to, size_t count);
+
+    /**
+     * Get the number of vertices.
+     */
+    inline int vertexcount() const { return priorities.size(); }
+
+    /**
+     * Get the number of edges that have been added, including duplicates.
+     */
+    inline size_t edgecount() const { return edges.size(); }
+
+    /**
+     * Make the game, with the in-edges if <in_edges> is set (see Game::build_in_array).
+     * Afterwards the builder is empty.
+     */
+    Game finish(bool in_edges = false);
+
+private:
+    void resize(int count);
+
+    std::vector<int> priorities;
+    std::vector<char> owners;
+    std::vector<uint64_t> labels;   // for every vertex, the Game::label_ref of its label in <arena>
+    std::string arena;
+    std::vector<uint64_t> edges;    // every edge as (source << 32 | target)
+};
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+
+namespace pg {
+
+/**
+ * A file that is mapped into memory (read-only, or as a private copy-on-write mapping).
+ * The mapping is removed when the object is destroyed.
+ */
+class MappedFile
+{
+public:
+    /**
+     * Map the file <filename> into memory. Throws std::runtime_error if that fails.
+     * If <writable> is set, then the mapping is private and writable: writes are not
+     * written back to the file, but the kernel copies the modified pages on demand.
+     */
+    MappedFile(const std::string &filename, bool writable=false);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Give a hint to the kernel that the mapping will be read sequentially.
+     */
+    void sequential();
+
+    inline char *data() const { return _data; }
+    inline size_t size() const { return _size; }
+
+    /**
+     * Returns whether <ptr> points into the mapping.
+     */
+    inline bool contains(const void *ptr) const
+    {
+        return (const char*)ptr >= _data and (const char*)ptr < _data + _size;
+    }
+
+private:
+    char *_data;
+    size_t _size;
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+
+namespace pg {
+
+/**
+ * The allocation policy for the large arrays of games and solvers (flags, see set_memory_policy).
+ */
+enum memory_policy {
+    MEM_DEFAULT    = 0,  // plain malloc
+    MEM_HUGEPAGES  = 1,  // back large arrays by transparent huge pages (madvise MADV_HUGEPAGE)
+    MEM_INTERLEAVE = 2,  // interleave the pages of large arrays over the allowed NUMA nodes (mbind MPOL_INTERLEAVE)
+    MEM_FIRSTTOUCH = 4   // touch new large arrays from all Lace workers, so the pages are placed near the workers
+};
+
+/**
+ * Set the allocation policy, a combination of memory_policy flags. This affects arrays that are allocated afterwards.
+ * With any policy other than MEM_DEFAULT, arrays of at least 1 MB are page-aligned (2 MB-aligned with MEM_HUGEPAGES)
+ * and the policy is applied before the pages are first touched.
+ */
+void set_memory_policy(int policy);
+
+/**
+ * Get the current allocation policy.
+ */
+int get_memory_policy(void);
+
+/**
+ * Allocate an array of <size> bytes according to the allocation policy.
+ * Like malloc, this returns NULL if out of memory, and the array is released with free.
+ */
+void *alloc_array(size_t size);
+
+/**
+ * Allocate an array of <size> bytes that is zeroed, like calloc.
+ */
+void *calloc_array(size_t size);
+
+/**
+ * Resize the array <ptr> of <old_size> bytes to <size> bytes, like realloc.
+ */
+void *realloc_array(void *ptr, size_t old_size, size_t size);
+
+}
+
+#endif
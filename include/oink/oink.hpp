@@ -29,6 +29,7 @@
 namespace pg {
 
 class Solver;
+class SubgameView;
 
 class Oink
 {
@@ -75,22 +76,54 @@ public:
      */
     void setRemoveWCWC(bool val) { removeWCWC = val; }
 
+    /**
+     * Instruct Oink whether to solve winner-controlled winning cycles with the parallel algorithm
+     * if Lace is running (see solveTrivialCyclesParallel). (Default false)
+     */
+    void setParallelWCWC(bool val) { parallelWCWC = val; }
+
     /**
      * Instruct Oink whether to solve single parity games. (Default true)
      */
     void setSolveSingle(bool val) { solveSingle = val; }
 
     /**
-     * Instruct Oink whether solve per bottom SCC. (Default false)
+     * Instruct Oink whether solve per SCC, starting from the bottom SCCs (see solveSCCs). (Default false)
      */
     void setBottomSCC(bool val) { bottomSCC = val; }
 
+    /**
+     * Instruct Oink to solve components of at most <size> vertices with <solver> instead of the solver
+     * set by setSolver. The components are the SCCs when solving per SCC (see setBottomSCC), and
+     * otherwise the subgame that is left after preprocessing.
+     */
+    void setSmallSolver(std::string solver, long size) { smallSolver = solver; smallSize = size; }
+
+    /**
+     * Instruct Oink to solve components of at least <size> vertices with <solver> instead of the solver
+     * set by setSolver (see setSmallSolver). With -w, a parallel solver here uses all workers.
+     */
+    void setLargeSolver(std::string solver, long size) { largeSolver = solver; largeSize = size; }
+
+    /**
+     * Instruct Oink whether to give the solver a SubgameView of the unsolved vertices when at most
+     * half of the game is left to solve, so the solver only allocates and scans arrays for the
+     * subgame. (Default true) When solving per SCC, the solvers always get a view of their SCC.
+     */
+    void setSubgameViews(bool val) { subgameViews = val; }
+
     /**
      * Set the number of workers for parallel solvers (psi and zielonka).
      * -1 for sequential code, 0 for autodetect.
      */
     void setWorkers(int count) { workers = count; }
 
+    /**
+     * Instruct Oink to flush in parallel if Lace is running and the game has at least <vertices> vertices.
+     * (Default 2^16; tests set 0 to run the parallel flush on small games.)
+     */
+    void setParallelFlush(long vertices) { parallelFlush = vertices; }
+
     /**
      * Set verbosity level (0 = normal, 1 = trace, 2 = debug)
      */
@@ -110,6 +143,7 @@ public:
 
     /**
      * After marking nodes as solved using solve(), flush attracts to the solved dominion.
+     * Runs in parallel on large games if Lace is running.
      */
     void flush(void);
 
@@ -120,6 +154,12 @@ protected:
      */
     int solveTrivialCycles(void);
 
+    /**
+     * Solve winner-controlled winning cycles, using the Lace workers.
+     * Solves the same vertices as solveTrivialCycles, but the number of cycles may differ.
+     */
+    int solveTrivialCyclesParallel(void);
+
     /**
      * Resolve self-loops.
      * Returns number of resolved self-loops.
@@ -151,15 +191,50 @@ protected:
      */
     void tarjan(int start_node, std::vector<int> &res, bool nonempty);
 
+    /**
+     * Solve the unsolved vertices per SCC, in reverse topological order of the SCCs.
+     * SCCs that are ready at the same time are solved at the same time if Lace is running.
+     */
+    void solveSCCs(void);
+
     /**
      * Run the solver in a loop until the game is solved.
      */
     void solveLoop(void);
     friend void _solve_loop(Oink*); // access point from a Lace worker
 
+    /**
+     * Get the solver for a component of <size> vertices (see setSmallSolver and setLargeSolver).
+     */
+    const std::string& solverFor(long size) const;
+
+    /**
+     * Construct and run the solver on the vertices that are not disabled.
+     */
+    void runSolver(void);
+
+    /**
+     * Make a view of the vertices <vertices> (in ascending order) for a solver.
+     */
+    SubgameView* makeView(std::vector<int> &&vertices);
+
+    /**
+     * Solve the vertices of the game that are solved in the view <sub> (without flushing).
+     */
+    void solveView(const SubgameView &sub);
+
+    /**
+     * The parallel version of flush (see flush).
+     */
+    void flushParallel(void);
+
     Game *game;              // game being solved
     std::ostream &logger;    // logger for trace/debug messages
     std::optional<std::string> solver; // which solver to use
+    std::optional<std::string> smallSolver; // which solver to use for small components
+    std::optional<std::string> largeSolver; // which solver to use for large components
+    long smallSize = 0;      // the largest size of a small component
+    long largeSize = 0;      // the smallest size of a large component
     int workers = -1;        // number of workers, 0 = autodetect, -1 = use non parallel
     int trace = 0;           // verbosity (0 for normal, 1 for trace, 2 for debug)
     bool inflate = false;    // inflate the game before solving
@@ -167,13 +242,21 @@ protected:
     bool renumber = false;   // renumber the game before solving (removes gaps)
     bool removeLoops = true; // resolve self-loops before solving
     bool removeWCWC = true;  // solve winner-controlled winning cycles before solving
+    bool parallelWCWC = false;// use the parallel algorithm for winner-controlled winning cycles
     bool solveSingle = true; // solve games with only 1 parity
     bool bottomSCC = false;  // solve per bottom SCC
+    bool subgameViews = true;// give the solver a view of the subgame if it is small
+    long parallelFlush = 1<<16;// the smallest game that is flushed in parallel (if Lace is running)
     std::string options = "";// options for the solver
 
     uintqueue todo;          // internal queue for solved nodes for flushing
     int *outcount;           // number of unsolved outgoing edges per node (for fast attraction)
     bitset disabled;         // which vertices are disabled
+    SubgameView *view = NULL;// the view of the subgame given to the solver that is constructed, if any
+    int *viewmap = NULL;     // the vertex of the view of every vertex of the game (see SubgameView)
+    std::ostream *solverLogger = NULL;// the logger given to the solver that is constructed, if not <logger>
+    uint32_t *attracted = NULL;// (node << 1) | winner of the nodes attracted in a round of the parallel flush
+    int *attracted_str = NULL;// the strategy of the attracted nodes
 
     friend class pg::Solver; // to allow access to edges
 };
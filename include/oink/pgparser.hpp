@@ -19,6 +19,7 @@
 
 #include <sstream>
 #include <memory>
+#include <vector>
 #include <oink/game.hpp>
 
 namespace pg {
@@ -41,6 +42,83 @@ public:
      * It does this by renumbering (compressing) the priorities afterwards.
      */
     static Game parse_pgsolver_renumber(std::istream &in, bool removeBadLoops);
+
+    /**
+     * What to do with the labels of the vertices.
+     */
+    enum label_mode {
+        LABELS_COPY,    // copy the labels into the label arena of the game
+        LABELS_MAPPED,  // refer to the labels in the mapped input file without copying (otherwise as LABELS_COPY)
+        LABELS_NONE     // ignore the labels
+    };
+
+    /**
+     * Parse a pgsolver game from the memory buffer <data> of <size> bytes.
+     * This scans the buffer directly and writes the edge arrays of the game without intermediate vectors.
+     * Like parse_pgsolver_renumber, this can handle priorities above INT_MAX by renumbering the priorities.
+     * If Lace is running, large buffers are parsed in parallel using parse_pgsolver_buffer_par.
+     *
+     * If <mapping> is given, the game is loaded in order of priority and with the in-edges built,
+     * as required by Oink, so Game::sort and Game::build_in_array have nothing left to do.
+     * The vertices are placed with a counting sort on the (renumbered) priorities and the out-edges
+     * and in-edges are written directly to their final positions. Afterwards <mapping> is as given
+     * by Game::sort, i.e., permute(mapping) restores the order of the input.
+     */
+    static Game parse_pgsolver_buffer(const char *data, size_t size, bool removeBadLoops, label_mode labels = LABELS_COPY, std::vector<int> *mapping = nullptr);
+
+    /**
+     * Parse a pgsolver game from the memory buffer <data> of <size> bytes using the Lace workers.
+     * The buffer is split into chunks of vertex lines, every worker parses chunks into local buffers,
+     * and then the edge arrays are filled in parallel using the prefix sum of the edge counts of the chunks.
+     * If the input is not a valid game, this uses the sequential parser to report the exact error.
+     * (Runs sequentially if Lace is not running.)
+     */
+    static Game parse_pgsolver_buffer_par(const char *data, size_t size, bool removeBadLoops, label_mode labels = LABELS_COPY, std::vector<int> *mapping = nullptr);
+
+    /**
+     * Buffers (and files) of at least <bytes> bytes are parsed in parallel if Lace is running (default 2^20),
+     * in chunks of at least <bytes>/4 bytes.
+     * Tests set this to 0 to parse small games in many small chunks.
+     */
+    static void set_parallel_parse(size_t bytes);
+    static size_t get_parallel_parse(void);
+
+    /**
+     * Parse an (uncompressed) pgsolver game file by mapping it into memory and using parse_pgsolver_buffer.
+     * With LABELS_MAPPED, the game keeps the file mapped and the labels refer to the mapping.
+     * If <mapping> is given, the game is loaded in order of priority (see parse_pgsolver_buffer).
+     */
+    static Game parse_pgsolver_file(const std::string &filename, bool removeBadLoops, label_mode labels = LABELS_COPY, std::vector<int> *mapping = nullptr);
+
+    /**
+     * Load a game in the binary .pgb format (see Game::write_binary).
+     * The file is mapped into memory and the arrays of the game point directly into the mapping,
+     * so loading does not depend on the number of edges. The mapping is private: modifying the game
+     * (e.g. with sort or renumber) only copies the modified pages and does not change the file.
+     */
+    static Game parse_binary_file(const std::string &filename, label_mode labels = LABELS_MAPPED);
+
+    /**
+     * Parse a game in the compact .pgc format (see Game::write_compact).
+     * The stream is decoded directly into the arrays of the game.
+     */
+    static Game parse_compact(std::istream &in, label_mode labels = LABELS_COPY);
+
+    /**
+     * Parse a deterministic parity automaton in the extended HOA format (as used by SYNTCOMP),
+     * where the controllable-AP header item marks the propositions of the controller.
+     * The automaton is expanded into a max/even game where player 0 is the controller: in every state,
+     * the environment chooses the uncontrollable propositions and then the controller chooses an edge.
+     * Both min/max and even/odd parity conditions (and Buchi/co-Buchi) are supported.
+     * If <initial> is given, it is set to the vertex of the initial state.
+     */
+    static Game parse_ehoa(std::istream &in, int *initial = NULL);
+
+private:
+    static Game parse_pgsolver_buffer_seq(const char *data, size_t size, bool removeBadLoops, label_mode labels, const std::shared_ptr<MappedFile> &file, std::vector<int> *mapping);
+    static Game parse_pgsolver_buffer_par(const char *data, size_t size, bool removeBadLoops, label_mode labels, const std::shared_ptr<MappedFile> &file, std::vector<int> *mapping);
+    static void order_parsed(Game &game, std::vector<int> &mapping);
+    static void validate_binary(const Game &game, uint64_t n_edges);
 };
 
 }
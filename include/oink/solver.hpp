@@ -20,14 +20,17 @@
 #include "oink/game.hpp"
 #include "oink/oink.hpp"
 #include "oink/error.hpp"
+#include "oink/subgame.hpp"
 
 namespace pg {
 
 /**
  * Base class for the parity game solvers.
  * A derived class should implement the run method, and solve all vertices of the game.
- * TODO: instead of having 'disabled' vertices, the constructor should simply get
- *       a 'subgame' bitset that identifies the part of the game that we need to solve.
+ * If Oink gives the solver a SubgameView, then the vertices are those of the view, and the methods
+ * below (and the disabled bitset) translate to the view; the solution is then only recorded in the
+ * view until the solver is done. Solvers should therefore only use these methods and not the game
+ * directly.
  */
 class Solver
 {
@@ -50,21 +53,33 @@ protected:
     std::ostream &logger;
     int trace = 0;
 
-    const bitset &disabled; // TODO change into subgame
-    //inline bool disabled(int vertex) { return oink.disabled[vertex]; }
+    SubgameView *sub;       // the subgame to solve, or NULL to solve the game (see Oink::setSubgameViews)
+    const bitset &disabled; // which vertices are disabled (already solved)
 
-    [[nodiscard]] long nodecount() const { return game.nodecount(); }
-    [[nodiscard]] long edgecount() const { return game.edgecount(); }
-    [[nodiscard]] int priority(int vertex) const { return game.priority(vertex); }
-    [[nodiscard]] int owner(int vertex) const { return game.owner(vertex); }
-    [[nodiscard]] const int* outs(int vertex) const { return game.outedges() + game.firstout(vertex); }
-    [[nodiscard]] const int* ins(int vertex) const { return game.inedges() + game.firstin(vertex); }
-    [[nodiscard]] Game::_label_vertex label_vertex(int v) const { return game.label_vertex(v); }
+    [[nodiscard]] long nodecount() const { return sub != NULL ? sub->nodecount() : game.nodecount(); }
+    [[nodiscard]] long edgecount() const { return sub != NULL ? sub->edgecount() : game.edgecount(); }
+    [[nodiscard]] int priority(int vertex) const { return priorities[vertex]; }
+    [[nodiscard]] int owner(int vertex) const { return owners[vertex]; }
+    [[nodiscard]] const int* outs(int vertex) const { return sub != NULL ? sub->outs(vertex) : game.outedges() + game.firstout(vertex); }
+    [[nodiscard]] const int* ins(int vertex) const { return sub != NULL ? sub->ins(vertex) : game.inedges() + game.firstin(vertex); }
+    [[nodiscard]] edge_range succs(int vertex) const { return sub != NULL ? sub->succs(vertex) : game.succs(vertex); }
+    [[nodiscard]] edge_range preds(int vertex) const { return sub != NULL ? sub->preds(vertex) : game.preds(vertex); }
+    [[nodiscard]] bool has_selfloop(int vertex) const { return sub != NULL ? sub->has_selfloop(vertex) : game.has_selfloop(vertex); }
+    [[nodiscard]] Game::_label_vertex label_vertex(int v) const { return game.label_vertex(to_game(v)); }
 
-    void solve(int node, int winner, int strategy) { oink.solve(node, winner, strategy); }
-    void flush() { oink.flush(); }
+    [[nodiscard]] bool isSolved(int vertex) const { return sub != NULL ? sub->isSolved(vertex) : game.isSolved(vertex); }
+    [[nodiscard]] int getWinner(int vertex) const { return sub != NULL ? sub->getWinner(vertex) : game.getWinner(vertex); }
+    [[nodiscard]] long count_unsolved() const { return sub != NULL ? sub->count_unsolved() : game.count_unsolved(); }
+
+    void solve(int node, int winner, int strategy) { if (sub != NULL) sub->solve(node, winner, strategy); else oink.solve(node, winner, strategy); }
+    void flush() { if (sub != NULL) sub->flush(); else oink.flush(); }
 
 private:
+    const int *priorities;  // the priority of every vertex (of the game or the view)
+    const bitset &owners;   // the owner of every vertex (of the game or the view)
+
+    [[nodiscard]] int to_game(int vertex) const { return sub != NULL ? sub->to_game(vertex) : vertex; }
+
     Oink& oink;
 };
 
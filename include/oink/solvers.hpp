@@ -77,6 +77,10 @@ public:
 
     /**
      * Add a solver to the set of solvers
+     * A solver that is not parallel must be reentrant: when solving per SCC with Lace workers,
+     * Oink runs instances of it on different SCCs at the same time (see Oink::solveSCCs).
+     * So it may not use global or static state; a solver that does must be added as parallel,
+     * then Oink runs one instance at a time (like psi).
      */
     static void add(const std::string& id, const std::string& description, bool isParallel, const SolverConstructor& constructor);
 
@@ -106,7 +110,7 @@ private:
     }
 
     /**
-     * Add a solver to the set of solvers
+     * Add a solver to the set of solvers (see add)
      */
     void _add(const std::string& id, const std::string& description, bool isParallel, const SolverConstructor& constructor)
     {
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SUBGAME_HPP
+#define SUBGAME_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <oink/game.hpp>
+
+namespace pg {
+
+/**
+ * A view of a subgame of a game that is left to solve, with vertices numbered 0..nodecount()-1.
+ *
+ * The vertices of the view are in the same order as in the game, so if the game is ordered by
+ * priority, then so is the view. The view has its own (compact) edge arrays with only the edges
+ * between vertices of the view, in the same layout as Game: every list of edges ends with -1, so
+ * the methods outs/ins/succs/preds can be used exactly as those of Game.
+ * Making the view costs time and memory proportional to the size of the subgame, and the game
+ * itself is not modified.
+ *
+ * The view is made by Oink for the solvers (see Oink::setSubgameViews and Solver). The solvers
+ * solve the vertices of the view with solve and flush, which only update the view. Afterwards,
+ * Oink copies the solution of the view to the game. Different views can thus be solved at the
+ * same time, as long as they do not share vertices and there are no edges between them.
+ */
+class SubgameView
+{
+public:
+    /**
+     * Make the view of the vertices <vertices> of <game>, which must be in ascending order.
+     * The array <map> has an entry for every vertex of the game, which is -1 except for the
+     * vertices of other views. The view writes its own vertices to <map> and resets them to -1
+     * when it is destroyed, so views of disjoint vertices can share the same map.
+     * Requires the in-edges of the game (see Game::build_in_array).
+     */
+    SubgameView(Game &game, std::vector<int> &&vertices, int *map);
+    ~SubgameView();
+
+    SubgameView(const SubgameView&) = delete;
+    SubgameView& operator=(const SubgameView&) = delete;
+
+    /**
+     * Get the number of vertices in the view.
+     */
+    inline long nodecount() const { return vertices.size(); }
+
+    /**
+     * Get the number of edges in the view.
+     */
+    inline long edgecount() const { return n_edges; }
+
+    inline int priority(const int v) const { return _priority[v]; }
+    inline int owner(const int v) const { return _owner[v]; }
+    inline const int* priorities() const { return _priority; }
+    inline const bitset& owners() const { return _owner; }
+
+    inline const int* outs(const int v) const { return _outedges + _firstouts[v]; }
+    inline const int* ins(const int v) const { return _inedges + _firstins[v]; }
+    inline edge_range succs(const int v) const { return edge_range(outs(v), _outcount[v]); }
+    inline edge_range preds(const int v) const { return edge_range(ins(v), _incount[v]); }
+
+    /**
+     * Check if vertex <v> has a self-loop.
+     */
+    inline bool has_selfloop(const int v) const { return _selfloop[v]; }
+
+    /**
+     * Compress the priorities of the view, as Game::compress does for a game: priorities of the same
+     * parity without other priorities between them (in the view) become the same priority.
+     * Requires that the game is ordered. Returns the number of priorities of the view.
+     */
+    int compress(void);
+
+    /**
+     * Get the vertex of the game of vertex <v> of the view.
+     */
+    inline int to_game(const int v) const { return vertices[v]; }
+
+    /**
+     * Solve vertex <v> of the view, won by <winner> with strategy <strategy> (a vertex of the view, or -1).
+     */
+    void solve(int v, int winner, int strategy);
+
+    /**
+     * Attract to the vertices solved since the last flush, within the view.
+     */
+    void flush(void);
+
+    /**
+     * Check if vertex <v> of the view is solved.
+     */
+    inline bool isSolved(const int v) const { return disabled[v]; }
+
+    /**
+     * Get the winner of vertex <v> of the view, or -1 if it is not solved.
+     */
+    inline int getWinner(const int v) const { return disabled[v] ? (int)won[v] : -1; }
+
+    /**
+     * Get the strategy of solved vertex <v> of the view (a vertex of the view, or -1).
+     */
+    inline int getStrategy(const int v) const { return strategy[v]; }
+
+    /**
+     * Get the number of vertices of the view that are not solved.
+     */
+    inline long count_unsolved() const { return nodecount() - disabled.count(); }
+
+    /**
+     * The disabled vertices of the view, which are the solved vertices.
+     */
+    bitset disabled;
+
+private:
+    std::vector<int> vertices; // the vertex of the game of every vertex of the view
+    int *map;                  // the vertex of the view of every vertex of the game (shared)
+
+    int *_priority;            // the priority of every vertex
+    bitset _owner;             // the owner of every vertex
+    bitset _selfloop;          // the vertices with a self-loop
+    long n_edges;
+
+    int *_outedges;            // the out-edges of every vertex, each list followed by -1
+    edge_t *_firstouts;
+    int *_outcount;
+    int *_inedges;             // the in-edges of every vertex, each list followed by -1
+    edge_t *_firstins;
+    int *_incount;
+
+    bitset won;                // the winner of every solved vertex
+    int *strategy;             // the strategy of every solved vertex
+    int *unsolved;             // the number of unsolved successors (for attraction)
+    std::vector<int> todo;     // the vertices solved since the last flush
+};
+
+}
+
+#endif
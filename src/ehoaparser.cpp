@@ -0,0 +1,586 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "oink/pgparser.hpp"
+
+namespace pg {
+
+/**
+ * Tokens of the HOA format.
+ */
+
+enum ehoa_kind { EHOA_EOF, EHOA_HEADER, EHOA_IDENT, EHOA_INT, EHOA_STRING, EHOA_ALIAS, EHOA_BODY, EHOA_END, EHOA_ABORT, EHOA_PUNCT };
+
+struct ehoa_token
+{
+    ehoa_kind kind;
+    std::string text;   // header name (without ':'), identifier, string or alias name (without '@')
+    uint64_t value;     // integer
+    char punct;         // one of []{}()!&|
+};
+
+/**
+ * A simple lexer that reads tokens from the stream.
+ */
+class ehoa_lexer
+{
+public:
+    ehoa_lexer(std::istream &in) : rd(in.rdbuf()), peeked(false) { }
+
+    const ehoa_token& peek()
+    {
+        if (!peeked) {
+            read(tok);
+            peeked = true;
+        }
+        return tok;
+    }
+
+    ehoa_token next()
+    {
+        peek();
+        peeked = false;
+        return tok;
+    }
+
+    bool next_is(char punct)
+    {
+        return peek().kind == EHOA_PUNCT and tok.punct == punct;
+    }
+
+    void expect(char punct)
+    {
+        if (!next_is(punct)) throw std::runtime_error(std::string("expecting '") + punct + "'");
+        next();
+    }
+
+    uint64_t expect_int()
+    {
+        if (peek().kind != EHOA_INT) throw std::runtime_error("expecting integer");
+        return next().value;
+    }
+
+private:
+    std::streambuf *rd;
+    ehoa_token tok;
+    bool peeked;
+
+    static bool is_ident(int ch)
+    {
+        return (ch >= 'a' and ch <= 'z') or (ch >= 'A' and ch <= 'Z') or (ch >= '0' and ch <= '9') or ch == '_' or ch == '-';
+    }
+
+    void skip_whitespace_and_comments()
+    {
+        for (;;) {
+            int ch = rd->sgetc();
+            if (ch == ' ' or ch == '\n' or ch == '\t' or ch == '\r') {
+                rd->sbumpc();
+            } else if (ch == '/') {
+                rd->sbumpc();
+                if (rd->sgetc() != '*') throw std::runtime_error("unexpected '/'");
+                rd->sbumpc();
+                // comments can be nested
+                int depth = 1, last = 0;
+                while (depth > 0) {
+                    ch = rd->sbumpc();
+                    if (ch == EOF) throw std::runtime_error("unterminated comment");
+                    if (last == '/' and ch == '*') { depth++; ch = 0; }
+                    else if (last == '*' and ch == '/') { depth--; ch = 0; }
+                    last = ch;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    void read(ehoa_token &t)
+    {
+        skip_whitespace_and_comments();
+        t.text.clear();
+        int ch = rd->sbumpc();
+        if (ch == EOF) {
+            t.kind = EHOA_EOF;
+        } else if (ch >= '0' and ch <= '9') {
+            t.kind = EHOA_INT;
+            t.value = ch - '0';
+            while ((ch = rd->sgetc()) >= '0' and ch <= '9') {
+                if (t.value > (UINT64_MAX-9)/10) throw std::runtime_error("integer too large");
+                t.value = 10*t.value + (ch - '0');
+                rd->sbumpc();
+            }
+        } else if (ch == '"') {
+            t.kind = EHOA_STRING;
+            while ((ch = rd->sbumpc()) != '"') {
+                if (ch == EOF) throw std::runtime_error("unterminated string");
+                if (ch == '\\') ch = rd->sbumpc();
+                t.text += (char)ch;
+            }
+        } else if (ch == '@') {
+            t.kind = EHOA_ALIAS;
+            while (is_ident(rd->sgetc())) t.text += (char)rd->sbumpc();
+        } else if (ch == '-') {
+            // --BODY--, --END-- or --ABORT--
+            t.text += (char)ch;
+            while (is_ident(rd->sgetc())) t.text += (char)rd->sbumpc();
+            if (t.text == "--BODY--") t.kind = EHOA_BODY;
+            else if (t.text == "--END--") t.kind = EHOA_END;
+            else if (t.text == "--ABORT--") t.kind = EHOA_ABORT;
+            else throw std::runtime_error("unexpected token " + t.text);
+        } else if (is_ident(ch)) {
+            t.text += (char)ch;
+            while (is_ident(rd->sgetc())) t.text += (char)rd->sbumpc();
+            if (rd->sgetc() == ':') {
+                rd->sbumpc();
+                t.kind = EHOA_HEADER;
+            } else {
+                t.kind = EHOA_IDENT;
+            }
+        } else if (strchr("[]{}()!&|", ch) != NULL) {
+            t.kind = EHOA_PUNCT;
+            t.punct = ch;
+        } else {
+            throw std::runtime_error(std::string("unexpected character '") + (char)ch + "'");
+        }
+    }
+};
+
+/**
+ * Labels are kept in disjunctive normal form, as a list of cubes over at most 64 atomic propositions.
+ * A cube is satisfied by the valuation <v> iff (v ^ value) & mask == 0.
+ */
+
+struct ehoa_cube
+{
+    uint64_t mask;
+    uint64_t value;
+};
+
+typedef std::vector<ehoa_cube> ehoa_dnf;
+
+static const size_t EHOA_MAX_CUBES = 1<<16;
+
+static ehoa_dnf
+ehoa_and(const ehoa_dnf &a, const ehoa_dnf &b)
+{
+    ehoa_dnf res;
+    for (auto &x : a) {
+        for (auto &y : b) {
+            // skip contradicting cubes
+            if (((x.value ^ y.value) & x.mask & y.mask) != 0) continue;
+            res.push_back({ x.mask | y.mask, x.value | y.value });
+            if (res.size() > EHOA_MAX_CUBES) throw std::runtime_error("label too complex");
+        }
+    }
+    return res;
+}
+
+static ehoa_dnf
+ehoa_not(const ehoa_dnf &a)
+{
+    // not (c1 or c2 ...) = (not c1) and (not c2) ...; not c = disjunction of the negated literals of c
+    ehoa_dnf res = { { 0, 0 } }; // true
+    for (auto &c : a) {
+        ehoa_dnf neg;
+        for (int i=0; i<64; i++) {
+            const uint64_t bit = uint64_t(1) << i;
+            if (c.mask & bit) neg.push_back({ bit, ~c.value & bit });
+        }
+        res = ehoa_and(res, neg);
+    }
+    return res;
+}
+
+static ehoa_dnf ehoa_parse_or(ehoa_lexer &lex, int n_aps, std::map<std::string, ehoa_dnf> &aliases);
+
+static ehoa_dnf
+ehoa_parse_not(ehoa_lexer &lex, int n_aps, std::map<std::string, ehoa_dnf> &aliases)
+{
+    if (lex.next_is('!')) {
+        lex.next();
+        return ehoa_not(ehoa_parse_not(lex, n_aps, aliases));
+    } else if (lex.next_is('(')) {
+        lex.next();
+        ehoa_dnf res = ehoa_parse_or(lex, n_aps, aliases);
+        lex.expect(')');
+        return res;
+    }
+
+    ehoa_token t = lex.next();
+    if (t.kind == EHOA_IDENT and t.text == "t") return { { 0, 0 } };
+    if (t.kind == EHOA_IDENT and t.text == "f") return { };
+    if (t.kind == EHOA_INT) {
+        if (t.value >= (uint64_t)n_aps) throw std::runtime_error("invalid atomic proposition");
+        const uint64_t bit = uint64_t(1) << t.value;
+        return { { bit, bit } };
+    }
+    if (t.kind == EHOA_ALIAS) {
+        auto it = aliases.find(t.text);
+        if (it == aliases.end()) throw std::runtime_error("unknown alias @" + t.text);
+        return it->second;
+    }
+    throw std::runtime_error("invalid label");
+}
+
+static ehoa_dnf
+ehoa_parse_and(ehoa_lexer &lex, int n_aps, std::map<std::string, ehoa_dnf> &aliases)
+{
+    ehoa_dnf res = ehoa_parse_not(lex, n_aps, aliases);
+    while (lex.next_is('&')) {
+        lex.next();
+        res = ehoa_and(res, ehoa_parse_not(lex, n_aps, aliases));
+    }
+    return res;
+}
+
+static ehoa_dnf
+ehoa_parse_or(ehoa_lexer &lex, int n_aps, std::map<std::string, ehoa_dnf> &aliases)
+{
+    ehoa_dnf res = ehoa_parse_and(lex, n_aps, aliases);
+    while (lex.next_is('|')) {
+        lex.next();
+        ehoa_dnf rhs = ehoa_parse_and(lex, n_aps, aliases);
+        res.insert(res.end(), rhs.begin(), rhs.end());
+        if (res.size() > EHOA_MAX_CUBES) throw std::runtime_error("label too complex");
+    }
+    return res;
+}
+
+/**
+ * Parse an acceptance signature "{ i j ... }" (if present) and add the sets to <sets>.
+ */
+static void
+ehoa_parse_acc_sig(ehoa_lexer &lex, std::vector<int> &sets, int n_sets)
+{
+    if (!lex.next_is('{')) return;
+    lex.next();
+    while (!lex.next_is('}')) {
+        uint64_t s = lex.expect_int();
+        if (s >= (uint64_t)n_sets) throw std::runtime_error("invalid acceptance set");
+        sets.push_back(s);
+    }
+    lex.next();
+}
+
+Game
+PGParser::parse_ehoa(std::istream &in, int *initial)
+{
+    ehoa_lexer lex(in);
+
+    /**
+     * Parse the header.
+     */
+
+    if (lex.peek().kind != EHOA_HEADER or lex.peek().text != "HOA") throw std::runtime_error("expecting HOA header");
+    lex.next();
+    if (lex.next().text != "v1") throw std::runtime_error("unsupported HOA version");
+
+    long n_states = -1;
+    long start = -1;
+    int n_aps = -1;
+    uint64_t controllable = 0;
+    bool parity = false, max = true, odd = false;
+    int n_sets = 0; // number of acceptance sets (priorities)
+    std::map<std::string, ehoa_dnf> aliases;
+
+    for (;;) {
+        ehoa_token t = lex.next();
+        if (t.kind == EHOA_BODY) break;
+        if (t.kind != EHOA_HEADER) throw std::runtime_error("expecting header item or --BODY--");
+
+        if (t.text == "States") {
+            uint64_t n = lex.expect_int();
+            if (n > INT_MAX/4) throw std::runtime_error("too many states");
+            n_states = n;
+        } else if (t.text == "Start") {
+            uint64_t s = lex.expect_int();
+            if (lex.next_is('&')) throw std::runtime_error("alternating automata are not supported");
+            if (start == -1) start = s; // for multiple initial states, we use the first
+        } else if (t.text == "AP") {
+            uint64_t n = lex.expect_int();
+            if (n > 64) throw std::runtime_error("too many atomic propositions");
+            n_aps = n;
+            for (int i=0; i<n_aps; i++) {
+                if (lex.next().kind != EHOA_STRING) throw std::runtime_error("expecting atomic proposition");
+            }
+        } else if (t.text == "controllable-AP") {
+            while (lex.peek().kind == EHOA_INT) {
+                uint64_t ap = lex.next().value;
+                if (ap >= 64) throw std::runtime_error("invalid controllable atomic proposition");
+                controllable |= uint64_t(1) << ap;
+            }
+        } else if (t.text == "Alias") {
+            if (n_aps == -1) throw std::runtime_error("Alias before AP");
+            if (lex.peek().kind != EHOA_ALIAS) throw std::runtime_error("expecting alias");
+            std::string name = lex.next().text;
+            aliases[name] = ehoa_parse_or(lex, n_aps, aliases);
+        } else if (t.text == "acc-name") {
+            std::string name = lex.next().text;
+            if (name == "parity") {
+                std::string minmax = lex.next().text;
+                std::string evenodd = lex.next().text;
+                if (minmax != "min" and minmax != "max") throw std::runtime_error("expecting min or max");
+                if (evenodd != "even" and evenodd != "odd") throw std::runtime_error("expecting even or odd");
+                max = minmax == "max";
+                odd = evenodd == "odd";
+                n_sets = lex.expect_int();
+            } else if (name == "Buchi") {
+                // Inf(0) is parity max even 1
+                n_sets = 1;
+            } else if (name == "co-Buchi") {
+                // Fin(0) is parity max odd 1
+                odd = true;
+                n_sets = 1;
+            } else {
+                throw std::runtime_error("expecting parity acceptance, not " + name);
+            }
+            parity = true;
+        } else {
+            // skip all other header items (Acceptance, name, tool, properties, ...)
+            while (lex.peek().kind != EHOA_HEADER and lex.peek().kind != EHOA_BODY) {
+                if (lex.peek().kind == EHOA_EOF) throw std::runtime_error("expecting --BODY--");
+                lex.next();
+            }
+        }
+    }
+
+    if (n_aps == -1) n_aps = 0;
+    if (!parity) throw std::runtime_error("missing acc-name (expecting parity acceptance)");
+    if (start == -1) throw std::runtime_error("missing initial state");
+    if (n_aps < 64) controllable &= (uint64_t(1) << n_aps) - 1;
+    const uint64_t uncontrollable = (n_aps == 64 ? ~uint64_t(0) : (uint64_t(1) << n_aps) - 1) & ~controllable;
+    if (__builtin_popcountll(uncontrollable) > 24) throw std::runtime_error("too many uncontrollable atomic propositions");
+
+    /**
+     * The game has three kinds of vertices:
+     * - for every state, a vertex of the environment that chooses the uncontrollable propositions
+     * - for every state and every choice of the environment, a vertex of the controller that chooses
+     *   an edge that is enabled for some value of the controllable propositions (identical vertices are merged)
+     * - for every edge, a vertex with the priority of the edge, leading to the vertex of the target state
+     * The controller is player 0 for even conditions and player 1 for odd conditions; afterwards the game is
+     * converted to max/even with the controller as player 0 using minmax and evenodd.
+     *
+     * For max conditions, the priority of an edge is its highest acceptance set plus 2, or 1 if it has none
+     * (an edge without acceptance sets is "below" set 0, with odd parity); other vertices have priority 0.
+     * For min conditions, the priority is the lowest acceptance set, or n_sets if it has none;
+     * other vertices have priority n_sets+1, which is never the lowest priority on a cycle.
+     *
+     * Vertices of states get the id of the state; other vertices are numbered ~0, ~1, ... during parsing.
+     */
+
+    const int controller = odd ? 1 : 0;
+    const int neutral = max ? 0 : n_sets+1;
+
+    std::vector<std::vector<int>> state_succ;   // successors of the state vertices
+    std::vector<int> other_prio, other_owner;
+    std::vector<std::vector<int>> other_succ;   // successors of the other vertices
+    int sink = -1;                              // vertex that the controller loses, if needed
+
+    auto add_vertex = [&] (int prio, int owner) {
+        other_prio.push_back(prio);
+        other_owner.push_back(owner);
+        other_succ.emplace_back();
+        return ~(int)(other_prio.size()-1);
+    };
+
+    auto edge_priority = [&] (std::vector<int> &sets) {
+        if (sets.empty()) return max ? 1 : n_sets;
+        return max ? *std::max_element(sets.begin(), sets.end()) + 2 : *std::min_element(sets.begin(), sets.end());
+    };
+
+    auto check_state = [&] (uint64_t s) {
+        if (n_states != -1 and s >= (uint64_t)n_states) throw std::runtime_error("invalid state");
+        if (s > INT_MAX/4) throw std::runtime_error("too many states");
+        if (state_succ.size() <= s) state_succ.resize(s+1);
+    };
+
+    auto get_sink = [&] () {
+        if (sink == -1) {
+            // a self-loop with the parity of the environment
+            int prio = max ? 1-controller : n_sets+1;
+            if (!max and prio%2 == controller) prio++;
+            sink = add_vertex(prio, 0);
+            other_succ[~sink].push_back(sink);
+        }
+        return sink;
+    };
+
+    std::vector<bool> seen;
+    struct ehoa_edge { ehoa_dnf label; int vertex; };
+    std::vector<ehoa_edge> edges;
+    std::map<std::vector<int>, int> choices;
+
+    // expand the current state: for every valuation of the uncontrollable propositions, the enabled edges
+    auto finish_state = [&] (int state) {
+        if (state == -1) return;
+        choices.clear();
+        uint64_t u = 0;
+        do {
+            std::vector<int> enabled;
+            for (int e=0; e<(int)edges.size(); e++) {
+                for (auto &c : edges[e].label) {
+                    if (((u ^ c.value) & c.mask & uncontrollable) == 0) {
+                        enabled.push_back(e);
+                        break;
+                    }
+                }
+            }
+            if (enabled.empty()) {
+                // no way to continue, the controller loses
+                choices.emplace(enabled, get_sink());
+            } else {
+                auto it = choices.find(enabled);
+                if (it == choices.end()) {
+                    int v = add_vertex(neutral, controller);
+                    for (int e : enabled) other_succ[~v].push_back(edges[e].vertex);
+                    choices.emplace(enabled, v);
+                }
+            }
+            u = (u - uncontrollable) & uncontrollable;
+        } while (u != 0);
+
+        for (auto &c : choices) {
+            if (std::find(state_succ[state].begin(), state_succ[state].end(), c.second) == state_succ[state].end()) {
+                state_succ[state].push_back(c.second);
+            }
+        }
+        edges.clear();
+    };
+
+    /**
+     * Parse the body.
+     */
+
+    int state = -1;
+    ehoa_dnf state_label;
+    std::vector<int> state_sets;
+
+    for (;;) {
+        const ehoa_token &t = lex.peek();
+        if (t.kind == EHOA_END) {
+            lex.next();
+            break;
+        } else if (t.kind == EHOA_ABORT) {
+            throw std::runtime_error("automaton was aborted");
+        } else if (t.kind == EHOA_EOF) {
+            throw std::runtime_error("expecting --END--");
+        } else if (t.kind == EHOA_HEADER and t.text == "State") {
+            lex.next();
+            finish_state(state);
+
+            state_label = { { 0, 0 } };
+            if (lex.next_is('[')) {
+                lex.next();
+                state_label = ehoa_parse_or(lex, n_aps, aliases);
+                lex.expect(']');
+            }
+            uint64_t s = lex.expect_int();
+            check_state(s);
+            if (seen.size() <= s) seen.resize(s+1);
+            if (seen[s]) throw std::runtime_error("duplicate state");
+            seen[s] = true;
+            state = s;
+            if (lex.peek().kind == EHOA_STRING) lex.next(); // ignore the name of the state
+            state_sets.clear();
+            ehoa_parse_acc_sig(lex, state_sets, n_sets);
+        } else {
+            if (state == -1) throw std::runtime_error("expecting State:");
+            if (!lex.next_is('[')) throw std::runtime_error("implicit edge labels are not supported");
+            lex.next();
+            ehoa_dnf label = ehoa_and(state_label, ehoa_parse_or(lex, n_aps, aliases));
+            lex.expect(']');
+            uint64_t target = lex.expect_int();
+            if (lex.next_is('&')) throw std::runtime_error("alternating automata are not supported");
+            check_state(target);
+            std::vector<int> sets(state_sets);
+            ehoa_parse_acc_sig(lex, sets, n_sets);
+
+            int v = add_vertex(edge_priority(sets), 0);
+            other_succ[~v].push_back(target);
+            edges.push_back({ std::move(label), v });
+        }
+    }
+    finish_state(state);
+
+    check_state(start);
+    if (n_states == -1) n_states = state_succ.size();
+    state_succ.resize(n_states);
+
+    /**
+     * Construct the game; states that were not given in the body have no edges, so the controller loses there.
+     */
+
+    for (long s=0; s<n_states; s++) {
+        if (state_succ[s].empty()) state_succ[s].push_back(get_sink());
+    }
+
+    const long n_vertices = n_states + other_prio.size();
+    if (n_vertices > INT_MAX) throw std::runtime_error("game too large");
+    auto map = [&] (int v) { return v >= 0 ? v : n_states + ~v; };
+
+    std::vector<int> priorities(n_vertices, neutral);
+    bitset owners(n_vertices);
+    std::vector<std::vector<int>> succ(n_vertices);
+    size_t n_edges = 0;
+    for (long s=0; s<n_states; s++) {
+        owners[s] = 1-controller;
+        for (int v : state_succ[s]) succ[s].push_back(map(v));
+        n_edges += succ[s].size();
+    }
+    for (size_t i=0; i<other_prio.size(); i++) {
+        priorities[n_states+i] = other_prio[i];
+        owners[n_states+i] = other_owner[i];
+        for (int v : other_succ[i]) succ[n_states+i].push_back(map(v));
+        n_edges += succ[n_states+i].size();
+    }
+
+    std::vector<std::string*> labels(n_vertices, nullptr);
+    Game res(n_vertices, n_edges, priorities, owners, succ, labels);
+
+    /**
+     * Convert to max/even with the controller as player 0.
+     */
+
+    int init = start;
+    std::vector<int> mapping(n_vertices);
+    auto sort = [&] () {
+        res.sort(mapping.data());
+        init = std::find(mapping.begin(), mapping.end(), init) - mapping.begin();
+    };
+    if (!max) {
+        // minmax reverses the order of the priorities
+        sort();
+        res.minmax();
+        res.is_ordered = false;
+    }
+    if (odd) {
+        sort();
+        res.evenodd();
+    }
+
+    if (initial != NULL) *initial = init;
+    return res;
+}
+
+}
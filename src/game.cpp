@@ -16,11 +16,18 @@
 
 #include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <climits>
 #include <cstring> // memset
+#include <functional>
+#include <type_traits>
 #include <iostream>
 #include <ctime>
+#include <mutex>
 
 #include "oink/game.hpp"
+#include "oink/memory.hpp"
+#include "lace.h"
 
 #define USE_MMAP 1
 
@@ -42,6 +49,8 @@ Game::Game() : _owner(0), solved(0), winner(0)
     _firstins = NULL;
     _incount = NULL;
     is_ordered = true;
+    sorted_succs = false;
+    selfloops_built = false;
     v_allocated = 0;
     e_allocated = 0;
     e_size = 0;
@@ -61,7 +70,7 @@ Game::Game(size_t nv, size_t ne, std::vector<int>& priorities, bitset& owners, s
     _owner = owners;
 
     // copy edges
-    int e = 0;
+    edge_t e = 0;
     for (auto v=0; v<n_vertices; v++) {
         const auto f = e;
         _firstouts[v] = e;
@@ -75,7 +84,7 @@ Game::Game(size_t nv, size_t ne, std::vector<int>& priorities, bitset& owners, s
 
     // copy labels
     for (auto v=0; v<n_vertices; v++) {
-        if (labels[v] != nullptr) _label[v] = new std::string(*labels[v]);
+        if (labels[v] != nullptr) set_label(v, *labels[v]);
     }
 
     // check if ordered
@@ -90,29 +99,27 @@ Game::Game(size_t nv, size_t ne, std::vector<int>& priorities, bitset& owners, s
 
 Game::~Game()
 {
-    for (int i=0; i<n_vertices; i++) {
-        if (_label[i]) delete _label[i];
-    }
-
-    free(_priority);
-    free(_label);
+    // arrays that point into a mapped .pgb file are released with the mapping,
+    // and arrays shared with copies of this game are released by the last game that uses them
+    release_array(_priority);
+    release_array(_label);
     free(strategy);
-    free(_firstouts);
-    free(_outcount);
-    free(_outedges);
+    release_array(_firstouts);
+    release_array(_outcount);
+    release_array(_outedges);
 
     if (_outvec != NULL) {
         delete[] _outvec;
     }
 
     if (_inedges != NULL) {
-        delete[] _inedges;
-        delete[] _firstins;
-        delete[] _incount;
+        release_array(_inedges);
+        release_array(_firstins);
+        release_array(_incount);
     }
 }
 
-Game::Game(int vcount, int ecount) : _owner(vcount), solved(vcount), winner(vcount)
+Game::Game(int vcount, long ecount) : _owner(vcount), solved(vcount), winner(vcount)
 {
     assert(vcount > 0);
     if (ecount == -1) ecount = size_t(4) * vcount; // reasonable default outdegree
@@ -124,16 +131,16 @@ Game::Game(int vcount, int ecount) : _owner(vcount), solved(vcount), winner(vcou
     e_allocated = vcount+ecount+1;  // extra space for -1
     e_size = 0;
 
-    _priority = (int*)malloc(sizeof(int[v_allocated]));
-    _label = (string**)calloc(v_allocated, sizeof(string*));
-    strategy = (int*)malloc(sizeof(int[v_allocated]));
-    _firstouts = (int*)malloc(sizeof(int[v_allocated]));
-    _outcount = (int*)malloc(sizeof(int[v_allocated]));
-    _outedges = (int*)malloc(sizeof(int[e_allocated]));
+    _priority = (int*)alloc_array(sizeof(int[v_allocated]));
+    _label = (uint64_t*)calloc_array(sizeof(uint64_t[v_allocated]));
+    strategy = (int*)alloc_array(sizeof(int[v_allocated]));
+    _firstouts = (edge_t*)alloc_array(sizeof(edge_t[v_allocated]));
+    _outcount = (int*)alloc_array(sizeof(int[v_allocated]));
+    _outedges = (int*)alloc_array(sizeof(int[e_allocated]));
     if (_priority == (int*)0) abort();
-    if (_label == (string**)0) abort();
+    if (_label == (uint64_t*)0) abort();
     if (strategy == (int*)0) abort();
-    if (_firstouts == (int*)0) abort();
+    if (_firstouts == (edge_t*)0) abort();
     if (_outcount == (int*)0) abort();
     if (_outedges == (int*)0) abort();
 
@@ -142,6 +149,8 @@ Game::Game(int vcount, int ecount) : _owner(vcount), solved(vcount), winner(vcou
     _firstins = NULL;
     _incount = NULL;
     is_ordered = true;
+    sorted_succs = false;
+    selfloops_built = false;
 
     std::fill(_firstouts, _firstouts+vcount, '\x00');
     std::fill(_outcount, _outcount+vcount, '\x00');
@@ -154,42 +163,41 @@ Game::Game(int vcount, int ecount) : _owner(vcount), solved(vcount), winner(vcou
 }
 
 /**
- * Make a deep clone of the given game <other>.
+ * Make a copy of the given game <other>, which shares the arrays of the topology with <other>.
  * Does not clone the vector representation.
- * Does not clone the <in> array.
  */
-Game::Game(const Game& other) : Game(other.n_vertices, other.e_size)
+Game::Game(const Game& other) : _owner(other._owner), _selfloop(other._selfloop), solved(other.solved), winner(other.winner)
 {
-    n_edges = other.n_edges;
-
-    memcpy(_priority, other._priority, sizeof(int[n_vertices]));
-    _owner = other._owner;
-    for (int i=0; i<n_vertices; i++) {
-        if (other._label[i]) _label[i] = new std::string(*other._label[i]);
-    }
+    other.share(*this);
+    _mapped = other._mapped;
 
-    // clone the edge out ARRAY
+    n_vertices = other.n_vertices;
+    n_edges = other.n_edges;
+    v_allocated = other.v_allocated;
+    e_allocated = other.e_allocated;
     e_size = other.e_size;
-    memcpy(_outedges, other._outedges, sizeof(int[e_size]));
-    memcpy(_firstouts, other._firstouts, sizeof(int[n_vertices]));
-    memcpy(_outcount, other._outcount, sizeof(int[n_vertices]));
-
-    // copy inedges
-    if (other._inedges != NULL) {
-         size_t len = n_vertices + n_edges;
-         _inedges = new int[len];
-         _firstins = new int[n_vertices];
-         _incount = new int[n_vertices];
-         memcpy(_inedges, other._inedges, sizeof(int[len]));
-         memcpy(_firstins, other._firstins, sizeof(int[n_vertices]));
-         memcpy(_incount, other._incount, sizeof(int[n_vertices]));
-    }
-
     is_ordered = other.is_ordered;
+    sorted_succs = other.sorted_succs;
+    selfloops_built = other.selfloops_built;
 
-    solved = other.solved;
-    winner = other.winner;
+    _priority = other._priority;
+    _label = other._label;
+    _label_arena = other._label_arena;
+    _label_file = other._label_file;
+
+    _outvec = NULL;
+    _outedges = other._outedges;
+    _firstouts = other._firstouts;
+    _outcount = other._outcount;
+    _inedges = other._inedges;
+    _firstins = other._firstins;
+    _incount = other._incount;
+
+    // copy the solution
+    strategy = (int*)alloc_array(sizeof(int[v_allocated]));
+    if (strategy == (int*)0) abort();
     memcpy(strategy, other.strategy, sizeof(int[n_vertices]));
+    std::fill(strategy+n_vertices, strategy+v_allocated, -1);
 
     set_random_seed(static_cast<unsigned int>(std::time(0)));
 }
@@ -260,6 +268,7 @@ Game::init_vertex(int v, int priority, int owner, std::string label)
 {
     assert(v >= 0);
     while (v >= n_vertices) v_sizeup();
+    unshare(_label, v_allocated);
     set_priority(v, priority);
     set_owner(v, owner);
     this->_label[v] = 0; // just ensure that it's properly zeroed before use
@@ -270,6 +279,7 @@ Game::init_vertex(int v, int priority, int owner, std::string label)
 void
 Game::set_priority(int node, int priority)
 {
+    unshare(_priority, v_allocated);
     _priority[node] = priority;
     if (is_ordered) {
         if (node > 0 and _priority[node-1] > _priority[node]) is_ordered = false;
@@ -286,9 +296,33 @@ Game::set_owner(int node, int owner)
 void
 Game::set_label(int node, std::string label)
 {
-    if (this->_label[node]) delete this->_label[node];
-    if (label != "") this->_label[node] = new std::string(label);
-    else this->_label[node] = 0;
+    unshare(_label, v_allocated);
+    if (label.empty()) {
+        this->_label[node] = 0;
+    } else {
+        // append to the arena; the old label (if any) is left in the arena
+        own_labels();
+        this->_label[node] = label_ref(_label_arena->size(), label.size());
+        _label_arena->append(label);
+    }
+}
+
+void
+Game::own_labels()
+{
+    if (_label_arena != nullptr and _label_arena.use_count() == 1 and _label_file == nullptr) return;
+
+    // copy the labels to a new arena
+    unshare(_label, v_allocated);
+    auto arena = std::make_shared<std::string>();
+    for (int i=0; i<n_vertices; i++) {
+        if (_label[i] == 0) continue;
+        std::string_view l = rawlabel(i);
+        _label[i] = label_ref(arena->size(), l.size());
+        arena->append(l);
+    }
+    _label_arena = arena;
+    _label_file = nullptr;
 }
 
 
@@ -313,6 +347,7 @@ Game::vec_init(void)
 void
 Game::vec_finish(void)
 {
+    unshare();
     e_size = 0;
     n_edges = 0;
     for (int v=0; v<n_vertices; v++) {
@@ -362,34 +397,142 @@ Game::vec_has_edge(int from, int to)
 bool
 Game::has_edge(int from, int to)
 {
+    if (from == to and selfloops_built) return _selfloop[from];
     return find_edge(from, to) != -1;
 }
 
-int
+edge_t
 Game::find_edge(int from, int to)
 {
-    for (int idx = _firstouts[from]; _outedges[idx] != -1; idx++) {
+    if (sorted_succs) {
+        const edge_range s = succs(from);
+        const int *it = std::lower_bound(s.begin(), s.end(), to);
+        return (it != s.end() and *it == to) ? it - _outedges : -1;
+    }
+    for (edge_t idx = _firstouts[from]; _outedges[idx] != -1; idx++) {
         if (_outedges[idx] == to) return idx;
     }
     return -1;
 }
 
+/**
+ * Helpers for reading and writing solutions and games in pgsolver format.
+ */
+
+static inline void
+append_int(std::string &buf, long value)
+{
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp+sizeof(tmp), value);
+    buf.append(tmp, res.ptr);
+}
+
+static inline void
+skip_blanks(const char *&p, const char *end)
+{
+    while (p != end and (*p == ' ' or *p == '\t' or *p == '\r')) p++;
+}
+
+static inline bool
+read_int(const char *&p, const char *end, long *res)
+{
+    bool neg = false;
+    const char *q = p;
+    if (q != end and (*q == '-' or *q == '+')) neg = *q++ == '-';
+    if (q == end or *q < '0' or *q > '9') return false;
+    long v = 0;
+    while (q != end and *q >= '0' and *q <= '9') {
+        if (v > (LONG_MAX-9)/10) return false;
+        v = 10*v + (*q++ - '0');
+    }
+    *res = neg ? -v : v;
+    p = q;
+    return true;
+}
+
+/**
+ * Vertices are written in blocks of this many vertices; blocks are formatted in parallel if Lace is running.
+ */
+static const long WRITE_BLOCK = 1<<15;
+
+typedef std::function<void(long, long, std::string&)> format_fn;
+
+VOID_TASK_4(format_blocks, const format_fn*, fmt, std::string*, bufs, long, first, long, count)
+{
+    if (count == 1) {
+        (*fmt)(first*WRITE_BLOCK, (first+1)*WRITE_BLOCK, *bufs);
+    } else {
+        SPAWN(format_blocks, fmt, bufs+count/2, first+count/2, count-count/2);
+        CALL(format_blocks, fmt, bufs, first, count/2);
+        SYNC(format_blocks);
+    }
+}
+
+/**
+ * Write vertices [0, n) to <out>, where <fmt>(from, to, buf) appends the text of vertices [from, to) to buf.
+ * (The given <to> may be larger than n.)
+ */
+static void
+write_blocks(std::ostream &out, long n, const format_fn &fmt)
+{
+    const long n_blocks = (n + WRITE_BLOCK - 1) / WRITE_BLOCK;
+    if (lace_workers() == 0 or n_blocks < 2) {
+        std::string buf;
+        for (long b=0; b<n_blocks; b++) {
+            buf.clear();
+            fmt(b*WRITE_BLOCK, std::min(n, (b+1)*WRITE_BLOCK), buf);
+            out.write(buf.data(), buf.size());
+        }
+    } else {
+        // format a round of blocks in parallel, then write them in order
+        const long round = 8*lace_workers();
+        std::vector<std::string> bufs(round);
+        const format_fn bounded = [&] (long from, long to, std::string &buf) { buf.clear(); fmt(from, std::min(n, to), buf); };
+        for (long b=0; b<n_blocks; b+=round) {
+            const long count = std::min(round, n_blocks-b);
+            RUN(format_blocks, &bounded, bufs.data(), b, count);
+            for (long i=0; i<count; i++) out.write(bufs[i].data(), bufs[i].size());
+        }
+    }
+}
+
+/**
+ * Parse a (partial) solution.
+ * Every line is "<vertex> <winner> [<strategy>];", where the strategy is given for vertices won by their owner.
+ * Empty lines and the "paritysol" header are ignored, as is the remainder of every line.
+ */
 void
 Game::parse_solution(std::istream &in)
 {
-    string line;
-    while (getline(in, line)) {
-        stringstream ss(line);
-        string token;
+    // read the entire stream
+    std::string data;
+    {
+        std::streambuf *rd = in.rdbuf();
+        char buf[1<<16];
+        std::streamsize len;
+        while ((len = rd->sgetn(buf, sizeof(buf))) > 0) data.append(buf, len);
+    }
 
-        // ignore empty line
-        if (!(ss >> token)) continue;
+    const char *p = data.data();
+    const char *end = p + data.size();
+    while (p != end) {
+        skip_blanks(p, end);
 
-        // ignore line with "paritysol"
-        if (token == "paritysol") continue;
+        // ignore empty line and line with "paritysol"
+        if (p == end or *p == '\n') {
+            if (p != end) p++;
+            continue;
+        }
+        if (end-p >= 9 and strncmp(p, "paritysol", 9) == 0) {
+            p = (const char*)memchr(p, '\n', end-p);
+            if (p == NULL) break;
+            p++;
+            continue;
+        }
 
         // get node
-        int ident = stoi(token);
+        long ident;
+        if (!read_int(p, end, &ident)) throw std::runtime_error("invalid node index");
         if (ident < 0 || ident >= n_vertices) {
             throw std::runtime_error("node index out of bounds");
         }
@@ -397,8 +540,9 @@ Game::parse_solution(std::istream &in)
         if (solved[ident]) throw std::runtime_error("node already solved");
 
         // parse winner
-        int w;
-        if (!(ss >> w)) throw std::runtime_error("missing winner");
+        long w;
+        skip_blanks(p, end);
+        if (!read_int(p, end, &w)) throw std::runtime_error("missing winner");
         if (w!= 0 && w!= 1) throw std::runtime_error("invalid winner");
 
         // set winner
@@ -407,14 +551,20 @@ Game::parse_solution(std::istream &in)
 
         // parse strategy
         if (w == _owner[ident]) {
-            int str;
-            if (!(ss >> str)) throw std::runtime_error("missing strategy for winning node");
+            long str;
+            skip_blanks(p, end);
+            if (!read_int(p, end, &str) or str < INT_MIN or str > INT_MAX) throw std::runtime_error("missing strategy for winning node");
             // if (!has_edge(ident, str)) throw std::runtime_error("strategy not successor of node");
             // actually this is already checked by the verifier
             strategy[ident] = str;
         } else {
             strategy[ident] = -1;
         }
+
+        // skip the rest of the line
+        p = (const char*)memchr(p, '\n', end-p);
+        if (p == NULL) break;
+        p++;
     }
 }
 
@@ -425,17 +575,182 @@ Game::write_pgsolver(std::ostream &os)
     os << "parity " << n_vertices << ";" << std::endl;
 
     // print vertices
+    write_blocks(os, n_vertices, [this] (long from, long to, std::string &buf) {
+        for (long i=from; i<to; i++) {
+            append_int(buf, i);
+            buf.push_back(' ');
+            append_int(buf, priority(i));
+            buf.push_back(' ');
+            buf.push_back(owner(i) ? '1' : '0');
+            buf.push_back(' ');
+            bool first = true;
+            for (auto curedge = outs(i); *curedge != -1; curedge++) {
+                if (first) first = false;
+                else buf.push_back(',');
+                append_int(buf, *curedge);
+            }
+            if (_label[i] != 0) {
+                buf.append(" \"");
+                buf.append(rawlabel(i));
+                buf.push_back('"');
+            }
+            buf.append(";\n");
+        }
+    });
+    os.flush();
+}
+
+void
+Game::write_binary(std::ostream &out)
+{
+    binary_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, binary_header::MAGIC, sizeof(hdr.magic));
+    hdr.version = binary_header::VERSION;
+    hdr.endian = binary_header::ENDIAN;
+    hdr.n_vertices = n_vertices;
+    hdr.n_edges = n_edges;
+    hdr.e_size = e_size;
+
+    // collect the labels as one blob with offsets
+    std::vector<uint64_t> label_offsets;
+    const bool has_labels = std::any_of(_label, _label+n_vertices, [] (uint64_t l) { return l != 0; });
+    if (has_labels) {
+        label_offsets.reserve(n_vertices+1);
+        label_offsets.push_back(0);
+        for (int i=0; i<n_vertices; i++) {
+            hdr.label_size += rawlabel(i).size();
+            label_offsets.push_back(hdr.label_size);
+        }
+    }
+
+    if (is_ordered) hdr.flags |= binary_header::FLAG_ORDERED;
+    if (_inedges != NULL) hdr.flags |= binary_header::FLAG_INEDGES;
+    if (has_labels) hdr.flags |= binary_header::FLAG_LABELS;
+    if (sizeof(edge_t) == 8) hdr.flags |= binary_header::FLAG_EDGE64;
+
+    // every section starts at a multiple of 64 bytes
+    size_t pos = 0;
+    auto align = [&] () {
+        static const char zeroes[64] = { 0 };
+        if (pos % 64) {
+            out.write(zeroes, 64 - pos % 64);
+            pos += 64 - pos % 64;
+        }
+    };
+    auto section = [&] (const void *data, size_t len) {
+        align();
+        out.write((const char*)data, len);
+        pos += len;
+    };
+
+    section(&hdr, sizeof(hdr));
+    section(_priority, sizeof(int[n_vertices]));
+    section(_owner.data(), sizeof(uint64_t[(n_vertices+63)/64]));
+    section(_firstouts, sizeof(edge_t[n_vertices]));
+    section(_outcount, sizeof(int[n_vertices]));
+    section(_outedges, sizeof(int[e_size]));
+    if (_inedges != NULL) {
+        section(_firstins, sizeof(edge_t[n_vertices]));
+        section(_incount, sizeof(int[n_vertices]));
+        section(_inedges, sizeof(int[n_vertices+n_edges]));
+    }
+    if (has_labels) {
+        section(label_offsets.data(), sizeof(uint64_t[n_vertices+1]));
+        align();
+        for (int i=0; i<n_vertices; i++) {
+            std::string_view l = rawlabel(i);
+            out.write(l.data(), l.size());
+        }
+    }
+}
+
+/**
+ * Helpers for the compact format: unsigned LEB128 varints and zigzag encoding of signed values.
+ */
+
+static inline void
+put_varint(std::string &buf, uint64_t value)
+{
+    while (value >= 0x80) {
+        buf.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+static inline uint64_t
+zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+void
+Game::write_compact(std::ostream &out)
+{
+    const bool has_labels = std::any_of(_label, _label+n_vertices, [] (uint64_t l) { return l != 0; });
+
+    std::string buf;
+    buf.reserve(1<<17);
+    auto flush = [&] (bool force) {
+        if (force or buf.size() >= (1<<16)) {
+            out.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    };
+
+    buf.append(compact_format::MAGIC, sizeof(compact_format::MAGIC));
+    put_varint(buf, compact_format::VERSION);
+    put_varint(buf, has_labels ? compact_format::FLAG_LABELS : 0);
+    put_varint(buf, n_vertices);
+    put_varint(buf, n_edges);
+
+    // priorities as runs (a sorted game has one run per priority)
+    int64_t last = 0;
+    for (int i=0; i<n_vertices;) {
+        int j = i+1;
+        while (j < n_vertices and _priority[j] == _priority[i]) j++;
+        put_varint(buf, zigzag(_priority[i] - last));
+        put_varint(buf, j - i);
+        last = _priority[i];
+        i = j;
+        flush(false);
+    }
+
+    // owners as bits
+    for (int i=0; i<n_vertices; i+=8) {
+        unsigned char byte = 0;
+        for (int k=0; k<8 and i+k<n_vertices; k++) if (_owner[i+k]) byte |= 1<<k;
+        buf.push_back((char)byte);
+        flush(false);
+    }
+
+    // sorted successors as deltas
+    std::vector<int> succ;
     for (int i=0; i<n_vertices; i++) {
-        os << i << " " << priority(i) << " " << owner(i) << " ";
+        succ.assign(outs(i), outs(i)+_outcount[i]);
+        std::sort(succ.begin(), succ.end());
+        put_varint(buf, succ.size());
+        int64_t prev = i;
         bool first = true;
-        for (auto curedge = outs(i); *curedge != -1; curedge++) {
-            if (first) first = false;
-            else os << ",";
-            os << *curedge;
+        for (int to : succ) {
+            put_varint(buf, first ? zigzag(to - prev) : (uint64_t)(to - prev));
+            prev = to;
+            first = false;
+        }
+        flush(false);
+    }
+
+    if (has_labels) {
+        for (int i=0; i<n_vertices; i++) {
+            std::string_view l = rawlabel(i);
+            put_varint(buf, l.size());
+            buf.append(l);
+            flush(false);
         }
-        if (_label[i] != 0 and !_label[i]->empty()) os << " \"" << *_label[i] << "\"";
-        os << ";" << std::endl;
     }
+
+    flush(true);
 }
 
 void
@@ -462,13 +777,147 @@ Game::write_sol(std::ostream &out)
     out << "paritysol " << solved.count() << ";" << std::endl;
 
     // print solution
-    for (int i=0; i<n_vertices; i++) {
-        if (solved[i]) {
-            out << i << " " << (winner[i] ? "1" : "0");
-            if (winner[i] == _owner[i] and strategy[i] != -1) out << " " << strategy[i];
-            out << ";" << std::endl;
+    write_blocks(out, n_vertices, [this] (long from, long to, std::string &buf) {
+        for (long i=from; i<to; i++) {
+            if (solved[i]) {
+                append_int(buf, i);
+                buf.append(winner[i] ? " 1" : " 0");
+                if (winner[i] == _owner[i] and strategy[i] != -1) {
+                    buf.push_back(' ');
+                    append_int(buf, strategy[i]);
+                }
+                buf.append(";\n");
+            }
         }
+    });
+    out.flush();
+}
+
+/**
+ * Reordering large games (sort, permute and build_in_array) runs in parallel if Lace is running.
+ * The vertices are split into blocks, and a function is run for all blocks in parallel.
+ * Blocks are a power of 2 of at least 2^14 vertices, so different blocks never write to the same word of a bitset.
+ */
+static size_t parallel_reorder = 1<<16; // smaller games are reordered sequentially (see set_parallel_reorder)
+
+static inline bool
+reorder_parallel(size_t n)
+{
+    return lace_workers() != 0 and n >= parallel_reorder;
+}
+
+void
+Game::set_parallel_reorder(size_t vertices)
+{
+    parallel_reorder = vertices;
+}
+
+size_t
+Game::get_parallel_reorder(void)
+{
+    return parallel_reorder;
+}
+
+typedef std::function<void(size_t)> block_fn;
+
+VOID_TASK_3(run_blocks, const block_fn*, fn, size_t, first, size_t, count)
+{
+    if (count == 1) {
+        (*fn)(first);
+    } else {
+        SPAWN(run_blocks, fn, first+count/2, count-count/2);
+        CALL(run_blocks, fn, first, count/2);
+        SYNC(run_blocks);
+    }
+}
+
+struct vertex_blocks
+{
+    size_t n;       // number of vertices
+    int shift;      // the block of vertex v is v >> shift
+    size_t size;    // number of vertices per block (a power of 2)
+    size_t count;   // number of blocks
+
+    vertex_blocks(size_t n) : n(n)
+    {
+        const size_t target = std::max(n / (8*lace_workers()), (size_t)1 << 14);
+        shift = 14;
+        while (((size_t)1 << shift) < target) shift++;
+        size = (size_t)1 << shift;
+        count = (n + size - 1) / size;
+    }
+
+    inline size_t first(size_t b) const { return b*size; }
+    inline size_t last(size_t b) const { return std::min((b+1)*size, n); }
+
+    void run(const block_fn &fn) const { RUN(run_blocks, &fn, 0, count); }
+};
+
+/**
+ * Compute the order of the vertices by (unsigned) priority, i.e., <mapping>[new] = old, and its <inverse>.
+ * Uses a stable LSD radix sort (8 bits per pass, skipping the bytes that are the same for all priorities)
+ * of the vertices together with their priority, with a histogram per block and a prefix sum per pass.
+ */
+static void
+sort_mapping_par(const int *priority, size_t n, int *mapping, int *inverse)
+{
+    const vertex_blocks blocks(n);
+
+    // find the bits that differ between the priorities
+    std::vector<uint32_t> block_diff(blocks.count);
+    blocks.run([&] (size_t b) {
+        uint32_t diff = 0;
+        for (size_t v=blocks.first(b); v<blocks.last(b); v++) diff |= (uint32_t)priority[v] ^ (uint32_t)priority[0];
+        block_diff[b] = diff;
+    });
+    uint32_t diff = 0;
+    for (uint32_t d : block_diff) diff |= d;
+
+    // every pair is the priority (high half) and the vertex (low half)
+    uint64_t *pairs = (uint64_t*)alloc_array(sizeof(uint64_t[n]));
+    uint64_t *tmp = (uint64_t*)alloc_array(sizeof(uint64_t[n]));
+    if (pairs == NULL or tmp == NULL) abort();
+    blocks.run([&] (size_t b) {
+        for (size_t v=blocks.first(b); v<blocks.last(b); v++) pairs[v] = (uint64_t)(uint32_t)priority[v] << 32 | v;
+    });
+
+    std::vector<size_t> counts(256*blocks.count);
+    for (int shift=0; shift<32; shift+=8) {
+        if (((diff >> shift) & 255) == 0) continue;
+        const int key = 32 + shift;
+        blocks.run([&] (size_t b) {
+            size_t *c = counts.data() + 256*b;
+            std::fill(c, c+256, 0);
+            for (size_t i=blocks.first(b); i<blocks.last(b); i++) c[(pairs[i] >> key) & 255]++;
+        });
+
+        // turn the counters into offsets, ordered by digit and then by block
+        size_t offset = 0;
+        for (int d=0; d<256; d++) {
+            for (size_t b=0; b<blocks.count; b++) {
+                const size_t c = counts[256*b+d];
+                counts[256*b+d] = offset;
+                offset += c;
+            }
+        }
+
+        blocks.run([&] (size_t b) {
+            size_t *offsets = counts.data() + 256*b;
+            for (size_t i=blocks.first(b); i<blocks.last(b); i++) tmp[offsets[(pairs[i] >> key) & 255]++] = pairs[i];
+        });
+        std::swap(pairs, tmp);
     }
+
+    blocks.run([&] (size_t b) {
+        for (size_t i=blocks.first(b); i<blocks.last(b); i++) {
+            const int v = (int)(uint32_t)pairs[i];
+            mapping[i] = v;
+            inverse[v] = i;
+        }
+    });
+
+    free(pairs);
+    free(tmp);
 }
 
 /**
@@ -488,15 +937,20 @@ Game::sort(int *mapping)
         sort(mapping);
         delete[] mapping;
     } else {
-        // initialize mapping
-        for (int i=0; i<n_vertices; i++) mapping[i] = i;
+        int *inverse = new int[n_vertices];
 
-        // sort the mapping
-        std::sort(mapping, mapping+n_vertices, [&](const int &a, const int &b) { return (unsigned int)priority(a)<(unsigned int)priority(b); });
+        if (reorder_parallel(n_vertices)) {
+            sort_mapping_par(_priority, n_vertices, mapping, inverse);
+        } else {
+            // initialize mapping
+            for (int i=0; i<n_vertices; i++) mapping[i] = i;
 
-        // now mapping stores the reorder, all we need to do now is reorder in-place
-        int *inverse = new int[n_vertices];
-        for (int i=0; i<n_vertices; i++) inverse[mapping[i]] = i;
+            // sort the mapping (stable, so the mapping is the same as with the radix sort of sort_mapping_par)
+            std::stable_sort(mapping, mapping+n_vertices, [&](const int &a, const int &b) { return (unsigned int)priority(a)<(unsigned int)priority(b); });
+
+            // now mapping stores the reorder, all we need to do now is reorder in-place
+            for (int i=0; i<n_vertices; i++) inverse[mapping[i]] = i;
+        }
 
         // apply the permutation
         unsafe_permute(inverse);
@@ -533,6 +987,13 @@ Game::permute(int *mapping)
 void
 Game::unsafe_permute(int *mapping)
 {
+    if (reorder_parallel(n_vertices)) {
+        permute_par(mapping);
+        return;
+    }
+
+    unshare();
+
     // first update vectors and arrays and the strategies
     for (int i=0; i<n_vertices; i++) {
         if (strategy[i] != -1) strategy[i] = mapping[strategy[i]];
@@ -541,6 +1002,9 @@ Game::unsafe_permute(int *mapping)
     for (unsigned long i=0; i<len; i++) {
         if (_outedges[i] != -1) _outedges[i] = mapping[_outedges[i]];
     }
+    if (sorted_succs) {
+        for (int v=0; v<n_vertices; v++) std::sort(_outedges+_firstouts[v], _outedges+_firstouts[v]+_outcount[v]);
+    }
     if (_inedges != NULL) {
         for (unsigned long i=0; i<len; i++) {
             if (_inedges[i] != -1) _inedges[i] = mapping[_inedges[i]];
@@ -556,6 +1020,7 @@ Game::unsafe_permute(int *mapping)
             // swap i and k
             std::swap(_priority[i], _priority[k]);
             { bool b = _owner[k]; _owner[k] = _owner[i]; _owner[i] = b; }
+            if (selfloops_built) { bool b = _selfloop[k]; _selfloop[k] = _selfloop[i]; _selfloop[i] = b; }
             std::swap(_label[i], _label[k]);
             // swap out array
             std::swap(_firstouts[i], _firstouts[k]);
@@ -573,10 +1038,141 @@ Game::unsafe_permute(int *mapping)
     }
 }
 
+/**
+ * Apply permutation out-of-place using the Lace workers.
+ * Every block of new positions gathers the fields of its vertices, and then the edge arrays are
+ * written compactly in the new order (with the positions from a prefix sum over the blocks).
+ */
+void
+Game::permute_par(const int *mapping)
+{
+    const vertex_blocks blocks(n_vertices);
+    const bool with_in = _inedges != NULL;
+
+    // the old position of every new position
+    int *from = (int*)alloc_array(sizeof(int[n_vertices]));
+    if (from == NULL) abort();
+    blocks.run([&] (size_t b) {
+        for (size_t i=blocks.first(b); i<blocks.last(b); i++) from[mapping[i]] = i;
+    });
+
+    int *priority = (int*)alloc_array(sizeof(int[v_allocated]));
+    uint64_t *label = (uint64_t*)calloc_array(sizeof(uint64_t[v_allocated]));
+    int *strat = (int*)alloc_array(sizeof(int[v_allocated]));
+    edge_t *firstouts = (edge_t*)alloc_array(sizeof(edge_t[v_allocated]));
+    int *outcount = (int*)alloc_array(sizeof(int[v_allocated]));
+    if (priority == NULL or label == NULL or strat == NULL or firstouts == NULL or outcount == NULL) abort();
+    edge_t *firstins = NULL;
+    int *incount = NULL;
+    if (with_in) {
+        firstins = (edge_t*)alloc_array(sizeof(edge_t[n_vertices]));
+        incount = (int*)alloc_array(sizeof(int[n_vertices]));
+        if (firstins == NULL or incount == NULL) abort();
+    }
+    bitset owner(_owner.size()), is_solved(solved.size()), is_winner(winner.size());
+    bitset selfloop(selfloops_built ? _selfloop.size() : 0);
+
+    // gather the vertex fields and count the size of the edge lists of every block
+    std::vector<size_t> block_out(blocks.count+1), block_in(blocks.count+1);
+    blocks.run([&] (size_t b) {
+        size_t outs = 0, ins = 0;
+        for (size_t i=blocks.first(b); i<blocks.last(b); i++) {
+            const int v = from[i];
+            priority[i] = _priority[v];
+            label[i] = _label[v];
+            strat[i] = strategy[v] == -1 ? -1 : mapping[strategy[v]];
+            outcount[i] = _outcount[v];
+            outs += _outcount[v] + 1;
+            if (with_in) {
+                incount[i] = _incount[v];
+                ins += _incount[v] + 1;
+            }
+        }
+        for (size_t i=blocks.first(b); i<blocks.last(b); i+=64) {
+            uint64_t o = 0, s = 0, w = 0, l = 0;
+            for (size_t k=0; k<64 and i+k<blocks.last(b); k++) {
+                const int v = from[i+k];
+                o |= (uint64_t)_owner[v] << k;
+                s |= (uint64_t)solved[v] << k;
+                w |= (uint64_t)winner[v] << k;
+                if (selfloops_built) l |= (uint64_t)_selfloop[v] << k;
+            }
+            owner.data()[i/64] = o;
+            is_solved.data()[i/64] = s;
+            is_winner.data()[i/64] = w;
+            if (selfloops_built) selfloop.data()[i/64] = l;
+        }
+        block_out[b+1] = outs;
+        block_in[b+1] = ins;
+    });
+
+    // the out-edges start after the leading -1, the in-edges at 0
+    block_out[0] = 1;
+    for (size_t b=0; b<blocks.count; b++) {
+        block_out[b+1] += block_out[b];
+        block_in[b+1] += block_in[b];
+    }
+    const size_t out_size = block_out[blocks.count];
+    const size_t in_size = block_in[blocks.count];
+
+    int *outedges = (int*)alloc_array(sizeof(int[out_size]));
+    if (outedges == NULL) abort();
+    outedges[0] = -1;
+    int *inedges = NULL;
+    if (with_in) {
+        inedges = (int*)alloc_array(sizeof(int[in_size]));
+        if (inedges == NULL) abort();
+    }
+
+    // write the edges of every block, relabeled
+    blocks.run([&] (size_t b) {
+        size_t out_pos = block_out[b], in_pos = block_in[b];
+        for (size_t i=blocks.first(b); i<blocks.last(b); i++) {
+            const int v = from[i];
+            firstouts[i] = out_pos;
+            for (int to : succs(v)) outedges[out_pos++] = mapping[to];
+            if (sorted_succs) std::sort(outedges+firstouts[i], outedges+out_pos);
+            outedges[out_pos++] = -1;
+            if (with_in) {
+                firstins[i] = in_pos;
+                for (int fr : preds(v)) inedges[in_pos++] = mapping[fr];
+                inedges[in_pos++] = -1;
+            }
+        }
+    });
+
+    // replace the arrays (arrays in a mapped .pgb file are released with the mapping,
+    // and shared arrays by the last game that uses them)
+    auto replace = [this] (auto *&arr, auto *copy) {
+        release_array(arr);
+        arr = copy;
+    };
+    replace(_priority, priority);
+    replace(_label, label);
+    replace(strategy, strat);
+    replace(_firstouts, firstouts);
+    replace(_outcount, outcount);
+    replace(_outedges, outedges);
+    if (with_in) {
+        replace(_firstins, firstins);
+        replace(_incount, incount);
+        replace(_inedges, inedges);
+    }
+    _owner.swap(owner);
+    if (selfloops_built) _selfloop.swap(selfloop);
+    solved.swap(is_solved);
+    winner.swap(is_winner);
+    e_size = out_size;
+    e_allocated = out_size;
+
+    free(from);
+}
+
 int
 Game::inflate()
 {
     assert(is_ordered);
+    unshare(_priority, v_allocated);
 
     if (n_vertices == 0) return 0;
     int d = 1;
@@ -598,6 +1194,7 @@ int
 Game::compress()
 {
     assert(is_ordered);
+    unshare(_priority, v_allocated);
 
     if (n_vertices == 0) return 0;
     int d = 1;
@@ -618,6 +1215,7 @@ int
 Game::renumber()
 {
     assert(is_ordered);
+    unshare(_priority, v_allocated);
 
     if (n_vertices == 0) return 0;
     int d = 1;
@@ -640,6 +1238,7 @@ void
 Game::evenodd()
 {
     assert(is_ordered);
+    unshare(_priority, v_allocated);
 
     // reassign priorities and reindex nodes
     int prio = -1, last = -1;
@@ -660,6 +1259,7 @@ void
 Game::minmax()
 {
     assert(is_ordered);
+    unshare(_priority, v_allocated);
 
     // reassign priorities and reindex nodes
     int prio = -1, last = -1;
@@ -673,6 +1273,72 @@ Game::minmax()
     }
 }
 
+void
+Game::reorder(reorder_method method, int *mapping)
+{
+    assert(is_ordered);
+
+    if (n_vertices == 0) return;
+    build_in_array(false);
+
+    // traverse the in-edges (the direction of attraction), starting from the vertices with high priority,
+    // or for RCM from the vertices with low degree, visiting the neighbours with low degree first
+    std::vector<int> seeds(n_vertices);
+    for (int i=0; i<n_vertices; i++) seeds[i] = n_vertices-1-i;
+    auto degree = [&] (int v) { return _incount[v] + _outcount[v]; };
+    if (method == REORDER_RCM) {
+        std::stable_sort(seeds.begin(), seeds.end(), [&] (int a, int b) { return degree(a) < degree(b); });
+    }
+
+    std::vector<int> queue;
+    queue.reserve(n_vertices);
+    bitset visited(n_vertices);
+    for (int seed : seeds) {
+        if (visited[seed]) continue;
+        visited[seed] = true;
+        size_t head = queue.size();
+        queue.push_back(seed);
+        while (head < queue.size()) {
+            const int v = queue[head++];
+            const size_t added = queue.size();
+            for (int from : preds(v)) {
+                if (visited[from]) continue;
+                visited[from] = true;
+                queue.push_back(from);
+            }
+            if (method == REORDER_RCM) {
+                std::stable_sort(queue.begin()+added, queue.end(), [&] (int a, int b) { return degree(a) < degree(b); });
+            }
+        }
+    }
+
+    std::vector<int> rank(n_vertices);
+    for (int i=0; i<n_vertices; i++) {
+        rank[queue[i]] = method == REORDER_RCM ? n_vertices-1-i : i;
+    }
+
+    // order every block of equal priority by rank; <order> then has the vertices in their new order
+    std::vector<int> &order = queue;
+    for (int i=0; i<n_vertices; i++) order[i] = i;
+    for (int lo=0; lo<n_vertices; ) {
+        int hi = lo+1;
+        while (hi < n_vertices and _priority[hi] == _priority[lo]) hi++;
+        std::sort(order.begin()+lo, order.begin()+hi, [&] (int a, int b) { return rank[a] < rank[b]; });
+        lo = hi;
+    }
+
+    std::vector<int> position(n_vertices);
+    for (int i=0; i<n_vertices; i++) position[order[i]] = i;
+
+    if (mapping != NULL) {
+        // the vertex at position i was the vertex mapping[order[i]] of the original game
+        for (int i=0; i<n_vertices; i++) rank[i] = mapping[order[i]];
+        std::copy(rank.begin(), rank.end(), mapping);
+    }
+
+    unsafe_permute(position.data());
+}
+
 std::unique_ptr<Game>
 Game::extract_subgame(const std::vector<int>& selection)
 {
@@ -696,7 +1362,7 @@ Game::extract_subgame(const bitset& mask, std::vector<int>& subgame_to_game)
     // also count the number of edges in the subgame
 
     int nv = mask.count();
-    int ne = 0;
+    long ne = 0;
     for (int v=0; v<n_vertices; v++) {
         if (mask[v]) {
             bool bad = true;
@@ -735,10 +1401,14 @@ Game::extract_subgame(const bitset& mask, std::vector<int>& subgame_to_game)
         game_to_subgame[v] = w;
 
         // initialize most stuff (except edges)
-        if (_label[v] != 0) res->init_vertex(w, _priority[v], _owner[v], *_label[v]);
-        else res->init_vertex(w, _priority[v], _owner[v], "");
+        res->init_vertex(w, _priority[v], _owner[v]);
+        res->_label[w] = _label[v];
     }
 
+    // the subgame shares the labels
+    res->_label_arena = _label_arena;
+    res->_label_file = _label_file;
+
     // now add all edges
 
     for (int w=0; w<nv; w++) {
@@ -750,6 +1420,9 @@ Game::extract_subgame(const bitset& mask, std::vector<int>& subgame_to_game)
         res->e_finish();
     }
 
+    // the mapping is monotone, so sorted successors stay sorted
+    res->sorted_succs = sorted_succs;
+
     // TODO: fix is_ordered?
 
     return res;
@@ -763,6 +1436,14 @@ Game::operator=(const Game &other)
     return *this;
 }
 
+Game&
+Game::operator=(Game &&other) noexcept
+{
+    Game g(std::move(other));
+    swap(g);
+    return *this;
+}
+
 void
 Game::swap(Game &other)
 {
@@ -771,6 +1452,8 @@ Game::swap(Game &other)
     std::swap(_priority, other._priority);
     std::swap(_owner, other._owner);
     std::swap(_label, other._label);
+    std::swap(_label_arena, other._label_arena);
+    std::swap(_label_file, other._label_file);
     std::swap(_outvec, other._outvec);
     std::swap(_outedges, other._outedges);
     std::swap(_firstouts, other._firstouts);
@@ -782,9 +1465,15 @@ Game::swap(Game &other)
     std::swap(winner, other.winner);
     std::swap(strategy, other.strategy);
     std::swap(is_ordered, other.is_ordered);
+    std::swap(sorted_succs, other.sorted_succs);
+    std::swap(selfloops_built, other.selfloops_built);
+    std::swap(_selfloop, other._selfloop);
     std::swap(v_allocated, other.v_allocated);
     std::swap(e_allocated, other.e_allocated);
     std::swap(e_size, other.e_size);
+    std::swap(_mapped, other._mapped);
+    std::swap(_shared, other._shared);
+    std::swap(_sharing, other._sharing);
 }
 
 void
@@ -803,29 +1492,192 @@ Game::copy_solution(Game &other)
     memcpy(strategy, other.strategy, sizeof(int[n_vertices]));
 }
 
+/**
+ * Copy the arrays that are shared or point into a mapped .pgb file to owned memory, then release the mapping.
+ * Required before any array is reallocated.
+ */
+void
+Game::unmap(void)
+{
+    unshare();
+    if (!_mapped) return;
+
+    auto own = [this] (auto *&arr, size_t len) {
+        if (!is_mapped(arr)) return;
+        auto copy = (std::remove_reference_t<decltype(arr)>)alloc_array(sizeof(*arr) * len);
+        if (copy == NULL) abort();
+        memcpy(copy, arr, sizeof(*arr) * len);
+        arr = copy;
+    };
+    own(_priority, v_allocated);
+    own(_firstouts, v_allocated);
+    own(_outcount, v_allocated);
+    own(_outedges, e_allocated);
+    if (_inedges != NULL) {
+        own(_inedges, n_vertices + n_edges);
+        own(_firstins, n_vertices);
+        own(_incount, n_vertices);
+    }
+
+    _mapped.reset();
+}
+
+/**
+ * Guards the creation of Game::_shared and all access to the shared_arrays objects (see game.hpp).
+ */
+static std::mutex share_mutex;
+
+Game::shared_arrays::~shared_arrays()
+{
+    // (normally empty, as every game releases or unshares its arrays)
+    for (auto &arr : arrays) {
+        if (!(mapped and mapped->contains(arr.first))) free(arr.first);
+    }
+}
+
+void
+Game::shared_arrays::drop(void *arr)
+{
+    // (share_mutex must be held)
+    auto it = std::find_if(arrays.begin(), arrays.end(), [arr] (auto &a) { return a.first == arr; });
+    assert(it != arrays.end());
+    if (--it->second == 0) {
+        if (!(mapped and mapped->contains(arr))) free(arr);
+        arrays.erase(it);
+    }
+}
+
+void
+Game::share(Game &copy) const
+{
+    std::lock_guard<std::mutex> guard(share_mutex);
+    if (!_shared) {
+        _shared = std::make_shared<shared_arrays>();
+        _shared->mapped = _mapped;
+    }
+    auto &arrays = _shared->arrays;
+    void *current[TOPOLOGY_ARRAYS] = { _priority, _label, _firstouts, _outcount, _outedges, _inedges, _firstins, _incount };
+    for (int i=0; i<TOPOLOGY_ARRAYS; i++) {
+        void *arr = current[i];
+        if (arr == NULL) {
+            copy._sharing[i] = NULL;
+            continue;
+        }
+        // register arrays that are not shared yet (such as in-edges built after an earlier copy)
+        auto it = std::find_if(arrays.begin(), arrays.end(), [arr] (auto &a) { return a.first == arr; });
+        if (_sharing[i] != arr) {
+            _sharing[i] = arr;
+            if (it == arrays.end()) it = arrays.insert(it, { arr, 1 });
+            else it->second++;
+        }
+        it->second++; // used by the copy
+        copy._sharing[i] = arr;
+    }
+    copy._shared = _shared;
+}
+
+void
+Game::forget_shared(const void *arr)
+{
+    bool any = false;
+    for (auto &sharing : _sharing) {
+        if (sharing == arr) sharing = NULL;
+        any |= sharing != NULL;
+    }
+    if (!any) _shared.reset();
+}
+
+void
+Game::release_array(void *arr)
+{
+    if (is_shared(arr)) {
+        {
+            std::lock_guard<std::mutex> guard(share_mutex);
+            _shared->drop(arr);
+        }
+        forget_shared(arr);
+    } else if (!is_mapped(arr)) {
+        free(arr);
+    }
+}
+
+template <typename T>
+void
+Game::unshare(T *&arr, size_t len)
+{
+    if (!is_shared(arr)) return;
+    {
+        std::lock_guard<std::mutex> guard(share_mutex);
+        auto &arrays = _shared->arrays;
+        auto it = std::find_if(arrays.begin(), arrays.end(), [arr] (auto &a) { return a.first == arr; });
+        assert(it != arrays.end());
+        if (it->second == 1) {
+            // no other game uses the array anymore, so take it back
+            arrays.erase(it);
+            forget_shared(arr);
+            return;
+        }
+    }
+    // (the other games do not modify the array while this game still uses it)
+    T *copy = (T*)alloc_array(sizeof(T) * len);
+    if (copy == NULL) abort();
+    memcpy(copy, arr, sizeof(T) * len);
+    {
+        std::lock_guard<std::mutex> guard(share_mutex);
+        _shared->drop(arr);
+    }
+    forget_shared(arr);
+    arr = copy;
+}
+
+void
+Game::unshare(void)
+{
+    if (!_shared) return;
+    unshare(_priority, v_allocated);
+    unshare(_label, v_allocated);
+    unshare(_firstouts, v_allocated);
+    unshare(_outcount, v_allocated);
+    unshare(_outedges, e_allocated);
+    if (_inedges != NULL) {
+        unshare(_inedges, n_vertices + n_edges);
+        unshare(_firstins, n_vertices);
+        unshare(_incount, n_vertices);
+    }
+    assert(!_shared);
+}
+
 void 
 Game::e_sizeup(void)
 {
-    e_allocated += e_allocated/2;
-    _outedges = (int*)realloc(_outedges, sizeof(int[e_allocated]));
+    unmap();
+    const size_t old_allocated = e_allocated;
+    if (old_allocated > EDGE_OFFSET_MAX) throw std::runtime_error("too many edges");
+    e_allocated = std::min(e_allocated + e_allocated/2, EDGE_OFFSET_MAX + 1);
+    _outedges = (int*)realloc_array(_outedges, sizeof(int[old_allocated]), sizeof(int[e_allocated]));
     if (_outedges == NULL) abort();
 }
 
 void
 Game::v_sizeup(void)
 {
+    unmap();
+    sorted_succs = false;
+    selfloops_built = false;
+    const size_t old_allocated = v_allocated;
     v_allocated += v_allocated/2;
     n_vertices = v_allocated;
-    _priority = (int*)realloc(_priority, sizeof(int[v_allocated]));
-    strategy = (int*)realloc(strategy, sizeof(int[v_allocated]));
-    _firstouts = (int*)realloc(_firstouts, sizeof(int[v_allocated]));
-    _outcount = (int*)realloc(_outcount, sizeof(int[v_allocated]));
-    _label = (string**)realloc(_label, sizeof(string*[v_allocated]));
+    _priority = (int*)realloc_array(_priority, sizeof(int[old_allocated]), sizeof(int[v_allocated]));
+    strategy = (int*)realloc_array(strategy, sizeof(int[old_allocated]), sizeof(int[v_allocated]));
+    _firstouts = (edge_t*)realloc_array(_firstouts, sizeof(edge_t[old_allocated]), sizeof(edge_t[v_allocated]));
+    _outcount = (int*)realloc_array(_outcount, sizeof(int[old_allocated]), sizeof(int[v_allocated]));
+    _label = (uint64_t*)realloc_array(_label, sizeof(uint64_t[old_allocated]), sizeof(uint64_t[v_allocated]));
     if (_priority == (int*)0) abort();
     if (strategy == (int*)0) abort();
-    if (_firstouts == (int*)0) abort();
+    if (_firstouts == (edge_t*)0) abort();
     if (_outcount == (int*)0) abort();
-    if (_label == (string**)0) abort();
+    if (_label == (uint64_t*)0) abort();
+    std::fill(_label+old_allocated, _label+v_allocated, 0);
     _owner.resize(v_allocated);
     solved.resize(v_allocated);
     winner.resize(v_allocated);
@@ -844,6 +1696,10 @@ Game::v_resize(size_t newsize)
 void
 Game::e_start(int source)
 {
+    sorted_succs = false;
+    selfloops_built = false;
+    unshare(_firstouts, v_allocated);
+    unshare(_outcount, v_allocated);
     _firstouts[source] = e_size;
     _outcount[source] = 0;
 }
@@ -852,6 +1708,8 @@ void
 Game::e_add(int source, int target)
 {
     if (e_size == e_allocated) e_sizeup();
+    unshare(_outedges, e_allocated);
+    unshare(_outcount, v_allocated);
     _outedges[e_size++] = target;
     _outcount[source] += 1;
     n_edges++;
@@ -861,6 +1719,7 @@ void
 Game::e_finish(void)
 {
     if (e_size == e_allocated) e_sizeup();
+    unshare(_outedges, e_allocated);
     _outedges[e_size++] = -1;
 }
 
@@ -869,17 +1728,24 @@ Game::build_in_array(bool rebuild)
 {
     if (_inedges != NULL) {
         if (rebuild) {
-            delete[] _inedges;
-            delete[] _firstins;
-            delete[] _incount;
+            // (mapped and shared arrays are released with the mapping or by the last game that uses them)
+            release_array(_inedges);
+            release_array(_firstins);
+            release_array(_incount);
         } else {
             return;
         }
     }
 
-    _inedges = new int[e_size];
-    _firstins = new int[n_vertices];
-    _incount = new int[n_vertices];
+    _inedges = (int*)alloc_array(sizeof(int[e_size]));
+    _firstins = (edge_t*)alloc_array(sizeof(edge_t[n_vertices]));
+    _incount = (int*)alloc_array(sizeof(int[n_vertices]));
+    if (_inedges == (int*)0 or _firstins == (edge_t*)0 or _incount == (int*)0) abort();
+
+    if (reorder_parallel(n_vertices)) {
+        build_in_array_par();
+        return;
+    }
 
     // set incount of each vertex
 
@@ -906,4 +1772,256 @@ Game::build_in_array(bool rebuild)
     }
 }
 
+/**
+ * Build the <in> array using the Lace workers, by partitioning the edges on their target:
+ * - every block of sources counts its edges to every block of targets (a histogram per block)
+ * - a prefix sum over the histograms gives the position of every pair (block of sources, block of targets)
+ *   in a buffer of edges, and the position of the in-edges of every block of targets
+ * - every block of sources writes its edges to the buffer, grouped by block of targets
+ * - every block of targets fills its in-lists from its part of the buffer
+ * The edges of each block of targets are in the order of their source, so the result is exactly the
+ * same as that of the sequential version, without atomic operations.
+ */
+void
+Game::build_in_array_par(void)
+{
+    const vertex_blocks blocks(n_vertices);
+    const size_t B = blocks.count;
+
+    // count the edges from every block to every block
+    std::vector<size_t> counts(B*B);
+    blocks.run([&] (size_t b) {
+        size_t *c = counts.data() + B*b;
+        for (size_t v=blocks.first(b); v<blocks.last(b); v++) {
+            for (int to : succs(v)) c[to >> blocks.shift]++;
+        }
+    });
+
+    // turn the counters into offsets, ordered by target block and then by source block
+    std::vector<size_t> target_edges(B+1), target_in(B+1);
+    size_t offset = 0;
+    for (size_t t=0; t<B; t++) {
+        target_edges[t] = offset;
+        for (size_t b=0; b<B; b++) {
+            const size_t c = counts[B*b+t];
+            counts[B*b+t] = offset;
+            offset += c;
+        }
+        target_in[t+1] = target_in[t] + (offset - target_edges[t]) + (blocks.last(t) - blocks.first(t));
+    }
+    target_edges[B] = offset;
+
+    // every edge as (target, source)
+    uint64_t *edges = (uint64_t*)alloc_array(sizeof(uint64_t[offset]));
+    if (edges == NULL) abort();
+    blocks.run([&] (size_t b) {
+        size_t *offsets = counts.data() + B*b;
+        for (size_t v=blocks.first(b); v<blocks.last(b); v++) {
+            for (int to : succs(v)) edges[offsets[to >> blocks.shift]++] = (uint64_t)to << 32 | v;
+        }
+    });
+
+    blocks.run([&] (size_t t) {
+        const size_t first = blocks.first(t), last = blocks.last(t);
+        std::fill(_incount+first, _incount+last, 0);
+        for (size_t i=target_edges[t]; i<target_edges[t+1]; i++) _incount[edges[i] >> 32]++;
+
+        size_t pos = target_in[t];
+        for (size_t v=first; v<last; v++) {
+            _firstins[v] = pos+_incount[v]; // start at end!!
+            _inedges[_firstins[v]] = -1;
+            pos += _incount[v] + 1;
+        }
+
+        for (size_t i=target_edges[t]; i<target_edges[t+1]; i++) {
+            _inedges[--_firstins[edges[i] >> 32]] = (int)(uint32_t)edges[i];
+        }
+    });
+
+    free(edges);
+}
+void
+Game::build_selfloops(void)
+{
+    if (selfloops_built) return;
+
+    bitset selfloop(n_vertices);
+    auto find = [&] (size_t first, size_t last) {
+        for (size_t v=first; v<last; v++) {
+            if (find_edge(v, v) != -1) selfloop.set(v);
+        }
+    };
+    if (reorder_parallel(n_vertices)) {
+        // (blocks are a multiple of 64 vertices, so they never write to the same word)
+        const vertex_blocks blocks(n_vertices);
+        blocks.run([&] (size_t b) { find(blocks.first(b), blocks.last(b)); });
+    } else {
+        find(0, n_vertices);
+    }
+
+    _selfloop.swap(selfloop);
+    selfloops_built = true;
+}
+
+void
+Game::sort_succs(void)
+{
+    if (sorted_succs) return;
+
+    unshare(_outedges, e_allocated);
+    auto sort = [&] (size_t first, size_t last) {
+        for (size_t v=first; v<last; v++) std::sort(_outedges+_firstouts[v], _outedges+_firstouts[v]+_outcount[v]);
+    };
+    if (reorder_parallel(n_vertices)) {
+        const vertex_blocks blocks(n_vertices);
+        blocks.run([&] (size_t b) { sort(blocks.first(b), blocks.last(b)); });
+    } else {
+        sort(0, n_vertices);
+    }
+
+    sorted_succs = true;
+}
+
+/**
+ * Write the edge arrays from the given pairs (source << 32 | target), after sorting them and removing duplicates.
+ * The pairs are sorted with a counting sort on their source (using _outcount and _firstouts as counters),
+ * followed by sorting the successors of every vertex, which is linear for bounded outdegree.
+ * For large games, this uses the Lace workers to first partition the pairs on their source, like build_in_array_par:
+ * - every chunk of pairs counts its pairs from every block of sources (a histogram per chunk)
+ * - a prefix sum over the histograms gives the position of the pairs of every block of sources
+ * - every chunk writes its pairs to a buffer, grouped by block of sources
+ * - every block of sources sorts its part of the buffer and then writes its successor lists
+ */
+void
+Game::load_edges(uint64_t *pairs, size_t count)
+{
+    assert(e_allocated >= n_vertices+count+1);
+
+    unshare();
+    if (_inedges != NULL) {
+        // (mapped and shared arrays are released with the mapping or by the last game that uses them)
+        release_array(_inedges);
+        release_array(_firstins);
+        release_array(_incount);
+        _inedges = NULL;
+        _firstins = NULL;
+        _incount = NULL;
+    }
+
+    // sort the <count> pairs <in> from the vertices <first> to <last> to <out> and remove duplicates;
+    // afterwards _outcount has the number of successors of every vertex; returns the number of edges
+    auto sort_block = [&] (size_t first, size_t last, const uint64_t *in, size_t count, uint64_t *out) {
+        std::fill(_outcount+first, _outcount+last, 0);
+        for (size_t i=0; i<count; i++) {
+            assert((in[i] >> 32) >= first and (in[i] >> 32) < last); // every source is a vertex of the game
+            _outcount[in[i] >> 32]++;
+        }
+        edge_t pos = 0;
+        for (size_t v=first; v<last; v++) {
+            _firstouts[v] = pos;
+            pos += _outcount[v];
+        }
+        for (size_t i=0; i<count; i++) out[_firstouts[in[i] >> 32]++] = in[i];
+
+        // now _firstouts[v] is the end of the pairs of v; sort them and move them down
+        size_t res = 0;
+        edge_t start = 0;
+        for (size_t v=first; v<last; v++) {
+            uint64_t *begin = out + start, *end = out + _firstouts[v];
+            start = _firstouts[v];
+            std::sort(begin, end);
+            end = std::unique(begin, end);
+            _outcount[v] = end - begin;
+            if (begin != out + res) std::copy(begin, end, out + res);
+            res += _outcount[v];
+        }
+        return res;
+    };
+
+    // write the successor lists of the vertices <first> to <last> from <sorted> to the edge array at <pos>,
+    // and set their self-loop flags
+    auto write_block = [&] (size_t first, size_t last, const uint64_t *sorted, edge_t pos) {
+        for (size_t v=first; v<last; v++) {
+            _firstouts[v] = pos;
+            for (int i=0; i<_outcount[v]; i++) {
+                assert((uint32_t)*sorted < (uint32_t)n_vertices);
+                const int to = (int)(uint32_t)*sorted++;
+                if ((size_t)to == v) _selfloop.set(v);
+                _outedges[pos++] = to;
+            }
+            _outedges[pos++] = -1;
+        }
+    };
+
+    uint64_t *buffer = (uint64_t*)alloc_array(sizeof(uint64_t[std::max(count, (size_t)1)]));
+    if (buffer == NULL) abort();
+    _outedges[0] = -1;
+
+    bitset selfloop(n_vertices);
+    _selfloop.swap(selfloop);
+    sorted_succs = true;
+    selfloops_built = true;
+
+    if (!reorder_parallel(n_vertices)) {
+        n_edges = sort_block(0, n_vertices, pairs, count, buffer);
+        write_block(0, n_vertices, buffer, 1);
+        e_size = 1 + n_vertices + n_edges;
+        free(buffer);
+        return;
+    }
+
+    const vertex_blocks blocks(n_vertices);
+    const size_t B = blocks.count;
+    const size_t chunk = (count + B - 1) / B;
+    auto chunk_first = [&] (size_t c) { return std::min(c*chunk, count); };
+
+    // count the pairs of every chunk from every block
+    std::vector<size_t> counts(B*B);
+    blocks.run([&] (size_t c) {
+        size_t *cnt = counts.data() + B*c;
+        for (size_t i=chunk_first(c); i<chunk_first(c+1); i++) {
+            assert((pairs[i] >> 32) < (uint64_t)n_vertices);
+            cnt[pairs[i] >> (32 + blocks.shift)]++;
+        }
+    });
+
+    // turn the counters into offsets, ordered by source block and then by chunk
+    std::vector<size_t> block_pairs(B+1);
+    size_t offset = 0;
+    for (size_t b=0; b<B; b++) {
+        block_pairs[b] = offset;
+        for (size_t c=0; c<B; c++) {
+            const size_t cnt = counts[B*c+b];
+            counts[B*c+b] = offset;
+            offset += cnt;
+        }
+    }
+    block_pairs[B] = offset;
+
+    blocks.run([&] (size_t c) {
+        size_t *offsets = counts.data() + B*c;
+        for (size_t i=chunk_first(c); i<chunk_first(c+1); i++) buffer[offsets[pairs[i] >> (32 + blocks.shift)]++] = pairs[i];
+    });
+
+    // sort every block back into <pairs>
+    std::vector<size_t> block_edges(B);
+    blocks.run([&] (size_t b) {
+        const size_t first = block_pairs[b];
+        block_edges[b] = sort_block(blocks.first(b), blocks.last(b), buffer+first, block_pairs[b+1]-first, pairs+first);
+    });
+
+    blocks.run([&] (size_t b) {
+        // the position of the successor lists of the block (the edges and the -1 of the vertices before the block)
+        edge_t pos = 1 + blocks.first(b);
+        for (size_t c=0; c<b; c++) pos += block_edges[c];
+        write_block(blocks.first(b), blocks.last(b), pairs+block_pairs[b], pos);
+    });
+
+    n_edges = 0;
+    for (size_t b=0; b<B; b++) n_edges += block_edges[b];
+    e_size = 1 + n_vertices + n_edges;
+
+    free(buffer);
+}
+
 }
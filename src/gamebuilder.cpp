@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "oink/gamebuilder.hpp"
+
+namespace pg {
+
+GameBuilder::GameBuilder(int count, size_t ecount)
+{
+    assert(count >= 0);
+    resize(count);
+    edges.reserve(ecount);
+}
+
+void
+GameBuilder::resize(int count)
+{
+    priorities.resize(count, 0);
+    owners.resize(count, 0);
+    labels.resize(count, 0);
+}
+
+void
+GameBuilder::init_vertex(int v, int priority, int owner, const std::string &label)
+{
+    assert(v >= 0);
+    if (v >= vertexcount()) {
+        // grow geometrically, but keep the exact number of vertices
+        const size_t count = priorities.size();
+        if ((size_t)v >= priorities.capacity()) {
+            const size_t cap = std::max((size_t)v+1, 2*count);
+            priorities.reserve(cap);
+            owners.reserve(cap);
+            labels.reserve(cap);
+        }
+        resize(v+1);
+    }
+    priorities[v] = priority;
+    owners[v] = owner ? 1 : 0;
+    if (label.empty()) {
+        labels[v] = 0;
+    } else {
+        // the old label (if any) is left in the arena
+        labels[v] = Game::label_ref(arena.size(), label.size());
+        arena.append(label);
+    }
+}
+
+void
+GameBuilder::add_edges(const int *from, const int *to, size_t count)
+{
+    const size_t first = edges.size();
+    edges.resize(first + count);
+    uint64_t *e = edges.data() + first;
+    for (size_t i=0; i<count; i++) {
+        assert(from[i] >= 0 and to[i] >= 0);
+        e[i] = (uint64_t)from[i] << 32 | (uint32_t)to[i];
+    }
+}
+
+void
+GameBuilder::add_edges(int from, const int *to, size_t count)
+{
+    assert(from >= 0);
+    const size_t first = edges.size();
+    edges.resize(first + count);
+    uint64_t *e = edges.data() + first;
+    const uint64_t source = (uint64_t)from << 32;
+    for (size_t i=0; i<count; i++) {
+        assert(to[i] >= 0);
+        e[i] = source | (uint32_t)to[i];
+    }
+}
+
+Game
+GameBuilder::finish(bool in_edges)
+{
+    const int n = vertexcount();
+    if (n == 0) {
+        assert(edges.empty());
+        return Game();
+    }
+
+    Game game(n, edges.size());
+
+    memcpy(game._priority, priorities.data(), sizeof(int[n]));
+    for (int v=0; v<n; v++) {
+        if (owners[v]) game._owner[v] = 1;
+    }
+    game.is_ordered = std::is_sorted(priorities.begin(), priorities.end());
+
+    if (!arena.empty()) {
+        memcpy(game._label, labels.data(), sizeof(uint64_t[n]));
+        game._label_arena = std::make_shared<std::string>(std::move(arena));
+    }
+
+    game.load_edges(edges.data(), edges.size());
+    if (in_edges) game.build_in_array(false);
+
+    // release the memory of the builder
+    std::vector<int>().swap(priorities);
+    std::vector<char>().swap(owners);
+    std::vector<uint64_t>().swap(labels);
+    std::string().swap(arena);
+    std::vector<uint64_t>().swap(edges);
+
+    return game;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "oink/mappedfile.hpp"
+
+namespace pg {
+
+MappedFile::MappedFile(const std::string &filename, bool writable) : _data(NULL), _size(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) throw std::runtime_error("unable to open file " + filename);
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("unable to stat file " + filename);
+    }
+
+    _size = st.st_size;
+    if (_size == 0) {
+        // cannot map an empty file
+        close(fd);
+        return;
+    }
+
+    int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *data = mmap(NULL, _size, prot, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after closing the file
+    if (data == MAP_FAILED) throw std::runtime_error("unable to map file " + filename);
+    _data = (char*)data;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != NULL) munmap(_data, _size);
+}
+
+void
+MappedFile::sequential()
+{
+    if (_data != NULL) madvise(_data, _size, MADV_SEQUENTIAL);
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "oink/memory.hpp"
+#include "lace.h"
+
+namespace pg {
+
+static int policy = MEM_DEFAULT;
+
+static const size_t LARGE_ARRAY = 1UL << 20;   // smaller arrays are always allocated with malloc
+static const size_t PAGE_BYTES = 1UL << 12;
+static const size_t HUGE_PAGE_BYTES = 1UL << 21;
+
+// from <numaif.h>, which requires libnuma
+static const int MPOL_INTERLEAVE_MODE = 3;
+static const unsigned long MPOL_F_MEMS_ALLOWED_FLAG = 1 << 2;
+
+void
+set_memory_policy(int p)
+{
+    policy = p;
+}
+
+int
+get_memory_policy(void)
+{
+    return policy;
+}
+
+/**
+ * Apply the policy to the whole pages of the array, before they are touched.
+ * These are only hints: if the kernel does not support them, nothing changes.
+ */
+static void
+advise_array(void *ptr, size_t size)
+{
+    const uintptr_t begin = ((uintptr_t)ptr + PAGE_BYTES - 1) & ~(PAGE_BYTES - 1);
+    const uintptr_t end = ((uintptr_t)ptr + size) & ~(PAGE_BYTES - 1);
+    if (end <= begin) return;
+
+#ifdef MADV_HUGEPAGE
+    if (policy & MEM_HUGEPAGES) madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#endif
+
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+    if (policy & MEM_INTERLEAVE) {
+        // interleave over all nodes that we may use
+        unsigned long nodes[16];
+        memset(nodes, 0, sizeof(nodes));
+        if (syscall(SYS_get_mempolicy, NULL, nodes, 8*sizeof(nodes), NULL, MPOL_F_MEMS_ALLOWED_FLAG) == 0) {
+            // (the kernel ignores the last bit of maxnode)
+            syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE_MODE, nodes, 8*sizeof(nodes)+1, 0);
+        }
+    }
+#endif
+}
+
+static const size_t TOUCH_BLOCK = HUGE_PAGE_BYTES;
+
+/**
+ * Zero the array in blocks of 2 MB, spread over the Lace workers.
+ */
+VOID_TASK_2(touch_array, char*, data, size_t, size)
+{
+    if (size <= TOUCH_BLOCK) {
+        memset(data, 0, size);
+    } else {
+        const size_t half = (size / TOUCH_BLOCK + 1) / 2 * TOUCH_BLOCK;
+        SPAWN(touch_array, data+half, size-half);
+        CALL(touch_array, data, half);
+        SYNC(touch_array);
+    }
+}
+
+/**
+ * Allocate a large array: aligned, advised, and (with MEM_FIRSTTOUCH) zeroed by the Lace workers.
+ * Sets <zeroed> if the array has been zeroed.
+ */
+static void *
+alloc_large(size_t size, bool *zeroed)
+{
+    void *ptr;
+    const size_t align = (policy & MEM_HUGEPAGES) ? HUGE_PAGE_BYTES : PAGE_BYTES;
+    if (posix_memalign(&ptr, align, size) != 0) return NULL;
+    advise_array(ptr, size);
+    *zeroed = false;
+    if ((policy & MEM_FIRSTTOUCH) and lace_workers() != 0) {
+        RUN(touch_array, (char*)ptr, size);
+        *zeroed = true;
+    }
+    return ptr;
+}
+
+void *
+alloc_array(size_t size)
+{
+    if (policy == MEM_DEFAULT or size < LARGE_ARRAY) return malloc(size);
+    bool zeroed;
+    return alloc_large(size, &zeroed);
+}
+
+void *
+calloc_array(size_t size)
+{
+    if (policy == MEM_DEFAULT or size < LARGE_ARRAY) return calloc(size, 1);
+    bool zeroed;
+    void *ptr = alloc_large(size, &zeroed);
+    if (ptr != NULL and !zeroed) memset(ptr, 0, size);
+    return ptr;
+}
+
+void *
+realloc_array(void *ptr, size_t old_size, size_t size)
+{
+    if (policy == MEM_DEFAULT or size < LARGE_ARRAY) return realloc(ptr, size);
+    // realloc does not keep the alignment, so allocate a new array and move the contents
+    bool zeroed;
+    void *res = alloc_large(size, &zeroed);
+    if (res == NULL) return NULL;
+    if (ptr != NULL) {
+        memcpy(res, ptr, std::min(old_size, size));
+        free(ptr);
+    }
+    return res;
+}
+
+}
@@ -25,6 +25,8 @@
 #include "oink/oink.hpp"
 #include "oink/solvers.hpp"
 #include "oink/solver.hpp"
+#include "oink/memory.hpp"
+#include "oink/subgame.hpp"
 #include "lace.h"
 
 namespace pg {
@@ -35,21 +37,25 @@ Oink::Oink(Game &game, std::ostream &out) : game(&game), logger(out), todo(game.
     game.ensure_sorted();
     // ensure arrays are built, but don't rebuild
     game.build_in_array(false);
+    // the self-loop flags for solveSelfloops, solveTrivialCycles and the SCC searches
+    game.build_selfloops();
 
     // initialize outcount (for flush)
-    outcount = new int[game.vertexcount()];
+    outcount = (int*)alloc_array(sizeof(int[game.vertexcount()]));
+    if (outcount == (int*)0) abort();
     for (int i=0; i<game.vertexcount(); i++) {
-        outcount[i] = 0;
-        const int *ptr = game.outedges() + game.firstout(i);
-        for (int to = *ptr; to != -1; to = *++ptr) {
-            if (!disabled[to]) outcount[i]++; // only count the non-disabled subgame
-        }
+        int count = 0;
+        for (int to : game.succs(i)) count += !disabled[to]; // only count the non-disabled subgame
+        outcount[i] = count;
     }
 }
 
 Oink::~Oink()
 {
-    delete[] outcount;
+    free(outcount);
+    free(attracted);
+    free(attracted_str);
+    free(viewmap);
 }
 
 /**
@@ -180,7 +186,7 @@ Oink::solveTrivialCycles()
              * Check if a single-node SCC without a self-loop
              */
             if (scc.size() == 1) {
-                if (!game->has_edge(idx, idx)) {
+                if (!game->has_selfloop(idx)) {
                     // no self-loop
                     done[idx] = -2; // never check again
                     scc.clear();
@@ -245,7 +251,7 @@ Oink::solveSelfloops()
     for (int v=0; v<game->vertexcount(); v++) {
         if (disabled[v]) continue; // skip vertices that are hidden
 
-        if (game->has_edge(v, v)) {
+        if (game->has_selfloop(v)) {
             if (game->owner(v) == (game->priority(v)&1)) {
                 // a winning selfloop
                 if (trace) logger << "winning self-loop with priority \033[1;34m" << game->priority(v) << "\033[m" << std::endl;
@@ -326,17 +332,107 @@ Oink::solve(int node, int win, int strategy)
     todo.push(node);
 }
 
+/**
+ * On large games (see setParallelFlush), flush runs in parallel if Lace is running. The solved vertices are then processed
+ * in rounds: the in-edges of the vertices solved in the previous round are spread over the workers,
+ * which decrement <outcount> atomically and claim every attracted vertex with an atomic OR on the
+ * disabled bitset, so every vertex is attracted once, with one strategy. After each round, the
+ * attracted vertices are marked as solved, and they are the solved vertices of the next round.
+ */
+static const size_t FLUSH_GRAIN = 256;    // number of solved vertices per task
+
+struct flush_round
+{
+    const Game *game;
+    int *outcount;
+    bitset *disabled;         // the disabled vertices (set atomically)
+    const uint32_t *solved;   // the vertices solved in the previous round
+    uint32_t *attracted;      // (vertex << 1) | winner of the vertices attracted in this round
+    int *strategy;            // the strategy of the attracted vertices
+    size_t count;             // the number of attracted vertices (updated atomically)
+};
+
+static void
+flush_vertices(flush_round *r, size_t first, size_t count)
+{
+    for (size_t i=first; i<first+count; i++) {
+        const int v = r->solved[i];
+        const int winner = r->game->getWinner(v);
+
+        for (int from : r->game->preds(v)) {
+            if (r->disabled->atomic_test(from) or r->game->isSolved(from)) continue;
+            const int owner = r->game->owner(from);
+            // a node of the loser is attracted when its last unsolved edge is gone
+            if (owner != winner and __atomic_sub_fetch(&r->outcount[from], 1, __ATOMIC_RELAXED) != 0) continue;
+            // claim the node (it may be attracted via another edge at the same time)
+            if (r->disabled->atomic_set(from)) continue;
+            const size_t idx = __atomic_fetch_add(&r->count, 1, __ATOMIC_RELAXED);
+            r->attracted[idx] = (uint32_t)from << 1 | winner;
+            r->strategy[idx] = owner == winner ? v : -1;
+        }
+    }
+}
+
+VOID_TASK_3(flush_par, flush_round*, r, size_t, first, size_t, count)
+{
+    if (count <= FLUSH_GRAIN) {
+        flush_vertices(r, first, count);
+    } else {
+        SPAWN(flush_par, r, first+count/2, count-count/2);
+        CALL(flush_par, r, first, count/2);
+        SYNC(flush_par);
+    }
+}
+
+void
+Oink::flushParallel()
+{
+    if (attracted == NULL) {
+        const int n = game->vertexcount();
+        attracted = (uint32_t*)alloc_array(sizeof(uint32_t[n]));
+        attracted_str = (int*)alloc_array(sizeof(int[n]));
+        if (attracted == NULL or attracted_str == NULL) abort();
+    }
+
+    flush_round r;
+    r.game = game;
+    r.outcount = outcount;
+    r.disabled = &disabled;
+    r.solved = &todo[0];
+    r.attracted = attracted;
+    r.strategy = attracted_str;
+
+    while (todo.nonempty()) {
+        const size_t count = todo.size();
+        r.count = 0;
+        if (count <= FLUSH_GRAIN) flush_vertices(&r, 0, count);
+        else RUN(flush_par, &r, 0, count);
+
+        // mark the attracted vertices as solved (they are already disabled)
+        todo.clear();
+        for (size_t i=0; i<r.count; i++) {
+            const int v = attracted[i] >> 1;
+            game->solve(v, attracted[i] & 1, attracted_str[i]);
+            todo.push(v);
+        }
+    }
+}
+
 void
 Oink::flush()
 {
     // the <todo> queue contains vertex that are marked as solved
 
+    if (lace_workers() != 0 and game->vertexcount() >= parallelFlush) {
+        flushParallel();
+        return;
+    }
+
     while (todo.nonempty()) {
         int v = todo.pop();
         bool winner = game->getWinner(v);
 
-        for (auto curedge = game->ins(v); *curedge != -1; curedge++) {
-            int from = *curedge;
+        for (int from : game->preds(v)) {
             if (!game->isSolved(from) and !disabled[from]) {
                 if (game->owner(from) == winner) {
                     // node of winner
@@ -366,6 +462,71 @@ VOID_TASK_1(solve_loop, Oink*, s)
     _solve_loop(s);
 }
 
+SubgameView*
+Oink::makeView(std::vector<int> &&vertices)
+{
+    if (viewmap == NULL) {
+        const int n = game->vertexcount();
+        viewmap = (int*)alloc_array(sizeof(int[n]));
+        if (viewmap == NULL) abort();
+        for (int v=0; v<n; v++) viewmap[v] = -1;
+    }
+    return new SubgameView(*game, std::move(vertices), viewmap);
+}
+
+void
+Oink::solveView(const SubgameView &sub)
+{
+    for (int v=0; v<sub.nodecount(); v++) {
+        if (!sub.isSolved(v)) continue;
+        const int str = sub.getStrategy(v);
+        solve(sub.to_game(v), sub.getWinner(v), str == -1 ? -1 : sub.to_game(str));
+    }
+}
+
+const std::string&
+Oink::solverFor(long size) const
+{
+    if (smallSolver and size <= smallSize) return *smallSolver;
+    if (largeSolver and size >= largeSize) return *largeSolver;
+    return *solver;
+}
+
+void
+Oink::runSolver()
+{
+    // the solver gets a view of the subgame, unless most of the game is left anyway
+    std::unique_ptr<SubgameView> sub;
+    const long n = game->vertexcount();
+    const long left = n - disabled.count();
+    if (subgameViews and 2*left <= n) {
+        std::vector<int> vertices;
+        vertices.reserve(left);
+        const uint64_t *bits = disabled.data();
+        for (long b=0; b<(n+63)/64; b++) {
+            uint64_t w = ~bits[b];
+            if (64*b+64 > n) w &= (UINT64_C(1) << (n % 64)) - 1;
+            for (; w != 0; w &= w - 1) vertices.push_back(64*b + __builtin_ctzll(w));
+        }
+        sub.reset(makeView(std::move(vertices)));
+        view = sub.get();
+    }
+
+    const std::string &id = solverFor(left);
+    if (id != *solver) logger << "solving " << left << " nodes using " << Solvers::desc(id) << std::endl;
+
+    auto s = Solvers::construct(id, *this, *game);
+    view = NULL;
+    if (!s->parseOptions(options)) {
+        logger << "error parsing options: " << options << std::endl;
+        exit(-1);
+    }
+    s->run();
+
+    // the solver only solved the view, so solve the game
+    if (sub) solveView(*sub);
+}
+
 void
 Oink::solveLoop()
 {
@@ -373,44 +534,15 @@ Oink::solveLoop()
      * Report chosen solver.
      */
     if (bottomSCC) {
-        do {
-            // disable all solved vertices
-            disabled = game->getSolved();  // copy assignment
-
-            // solve bottom SCC
-            std::vector<int> sel;
-            getBottomSCC(sel);
-            assert(sel.size() != 0);
-            disabled.set();
-            for (int i : sel) disabled[i] = false;
-
-            logger << "solving bottom SCC of " << sel.size() << " nodes (";
-            logger << game->count_unsolved() << " nodes left)" << std::endl;
-
-            // solve current subgame
-            auto s = Solvers::construct(*solver, *this, *game);
-            if (!s->parseOptions(options)) {
-                logger << "error parsing options: " << options << std::endl;
-                exit(-1);
-            }
-            s->run();
-
-            // flush the todo buffer
-            flush();
-        } while (!game->game_solved());
+        solveSCCs();
     } else {
         do {
             // disable all solved vertices
             disabled = game->getSolved();
 
             // solve current subgame
-            auto s = Solvers::construct(*solver, *this, *game);
+            runSolver();
             bool fullSolver = true; // every solver is actually a full solver
-            if (!s->parseOptions(options)) {
-                logger << "error parsing options: " << options << std::endl;
-                exit(-1);
-            }
-            s->run();
 
             if (fullSolver) {
                 // trash the todo buffer
@@ -475,7 +607,7 @@ Oink::run()
     }
 
     if (removeWCWC) {
-        int count = solveTrivialCycles();
+        int count = parallelWCWC and lace_workers() != 0 ? solveTrivialCyclesParallel() : solveTrivialCycles();
         if (count == 0) logger << "no trivial cycles removed." << std::endl;
         else if (count == 1) logger << "1 trivial cycle removed." << std::endl;
         else logger << count << " trivial cycles removed." << std::endl;
@@ -503,11 +635,21 @@ Oink::run()
      * - if parallel solver, -w [0..N] and Lace is not running, start Lace
      * - if parallel solver, -w -1, run sequential anyway
      * - if sequential solver, run sequantial
+     * (a solver is parallel if any of the solvers for the components is parallel)
      */
 
     logger << "solving using " << Solvers::desc(*solver) << std::endl;
+    bool parallel = Solvers::isParallel(*solver);
+    if (smallSolver) {
+        logger << "components of at most " << smallSize << " nodes: " << Solvers::desc(*smallSolver) << std::endl;
+        parallel |= Solvers::isParallel(*smallSolver);
+    }
+    if (largeSolver) {
+        logger << "components of at least " << largeSize << " nodes: " << Solvers::desc(*largeSolver) << std::endl;
+        parallel |= Solvers::isParallel(*largeSolver);
+    }
 
-    if (Solvers::isParallel(*solver)) {
+    if (parallel) {
         if (workers >= 0) {
             if (lace_workers() == 0) {
                 lace_start(workers, 0);
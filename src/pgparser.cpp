@@ -14,13 +14,18 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <stdexcept>
 #include <map>
 #include <set>
 #include <vector>
-#include <boost/container/flat_map.hpp>
 #include "oink/pgparser.hpp"
+#include "oink/mappedfile.hpp"
+#include "oink/memory.hpp"
 #include "printf.hpp"
+#include "lace.h"
 
 namespace pg {
 
@@ -67,6 +72,236 @@ read_uint64(std::streambuf *rd, uint64_t *res)
     return true;
 }
 
+/**
+ * Renumbering of priorities, for parsers that read priorities as 64-bit numbers.
+ * The ordered distinct priorities are compressed while preserving their parity, i.e., the lowest priority
+ * becomes 0 (if it is 0) or 1 or 2, then every next distinct priority gets the next number with its parity.
+ *
+ * For large games, if Lace is running, this runs in parallel on blocks of vertices:
+ * - dense priorities are marked in a bitset, then a sweep over the bitset assigns the numbers,
+ *   and all vertices are renumbered in parallel
+ * - sparse priorities are sorted together with their vertex using a parallel LSD radix sort
+ *   (8 bits per pass, skipping the bytes that are the same for all priorities),
+ *   then a sweep over the sorted pairs assigns the numbers
+ */
+
+struct renumber_pair
+{
+    uint64_t priority;
+    int vertex;
+};
+
+struct renumber_job
+{
+    enum { STATS, MARK, REMAP, INIT, HISTOGRAM, SCATTER } phase;
+    const uint64_t *priority;   // the priorities
+    size_t n;                   // number of vertices
+    size_t block;               // number of vertices per block
+    uint64_t *block_max;        // (STATS) highest priority in every block
+    uint64_t *block_diff;       // (STATS) bits that differ from priority[0] in every block
+    bitset *used;               // (MARK) the used priorities
+    const int *map;             // (REMAP) the number of every priority
+    int *result;                // (REMAP) the renumbered priorities
+    renumber_pair *in;          // (INIT, HISTOGRAM, SCATTER) pairs in the current order
+    renumber_pair *out;         // (SCATTER) pairs in the next order
+    int shift;                  // (HISTOGRAM, SCATTER) the current byte
+    size_t *counts;             // (HISTOGRAM, SCATTER) 256 counters per block, then the offsets
+};
+
+static void
+renumber_block(renumber_job *job, size_t b)
+{
+    const size_t first = b * job->block;
+    const size_t last = std::min(first + job->block, job->n);
+    const uint64_t *priority = job->priority;
+    switch (job->phase) {
+    case renumber_job::STATS: {
+        uint64_t max = 0, diff = 0;
+        for (size_t v=first; v<last; v++) {
+            max = std::max(max, priority[v]);
+            diff |= priority[v] ^ priority[0];
+        }
+        job->block_max[b] = max;
+        job->block_diff[b] = diff;
+        break;
+    }
+    case renumber_job::MARK:
+        for (size_t v=first; v<last; v++) {
+            // check first (other tasks set bits concurrently), to avoid writing to shared cache lines
+            if (!job->used->atomic_test(priority[v])) job->used->atomic_set(priority[v]);
+        }
+        break;
+    case renumber_job::REMAP:
+        for (size_t v=first; v<last; v++) job->result[v] = job->map[priority[v]];
+        break;
+    case renumber_job::INIT:
+        for (size_t v=first; v<last; v++) job->in[v] = { priority[v], (int)v };
+        break;
+    case renumber_job::HISTOGRAM: {
+        size_t *counts = job->counts + 256*b;
+        std::fill(counts, counts+256, 0);
+        for (size_t v=first; v<last; v++) counts[(job->in[v].priority >> job->shift) & 255]++;
+        break;
+    }
+    case renumber_job::SCATTER: {
+        size_t *offsets = job->counts + 256*b;
+        for (size_t v=first; v<last; v++) {
+            const renumber_pair &pair = job->in[v];
+            job->out[offsets[(pair.priority >> job->shift) & 255]++] = pair;
+        }
+        break;
+    }
+    }
+}
+
+VOID_TASK_3(renumber_blocks, renumber_job*, job, size_t, first, size_t, count)
+{
+    if (count == 1) {
+        renumber_block(job, first);
+    } else {
+        SPAWN(renumber_blocks, job, first+count/2, count-count/2);
+        CALL(renumber_blocks, job, first, count/2);
+        SYNC(renumber_blocks);
+    }
+}
+
+static void
+renumber_priorities_par(const uint64_t *priority, size_t n, int *out)
+{
+    renumber_job job;
+    job.priority = priority;
+    job.n = n;
+    job.block = std::max(n / (8*lace_workers()), (size_t)1 << 14);
+    const size_t n_blocks = (n + job.block - 1) / job.block;
+
+    // find the highest priority and the bits that differ between the priorities
+    std::vector<uint64_t> block_max(n_blocks), block_diff(n_blocks);
+    job.block_max = block_max.data();
+    job.block_diff = block_diff.data();
+    job.phase = renumber_job::STATS;
+    RUN(renumber_blocks, &job, 0, n_blocks);
+    const uint64_t max = *std::max_element(block_max.begin(), block_max.end());
+    uint64_t diff = 0;
+    for (uint64_t d : block_diff) diff |= d;
+
+    if (diff == 0) {
+        // all priorities are the same
+        std::fill(out, out+n, priority[0] == 0 ? 0 : 2 - (int)(priority[0]&1));
+        return;
+    }
+
+    if (max < 4*n + 1024) {
+        // dense priorities: mark the used priorities and assign the numbers in a single sweep
+        bitset used(max+1);
+        job.used = &used;
+        job.phase = renumber_job::MARK;
+        RUN(renumber_blocks, &job, 0, n_blocks);
+
+        std::vector<int> map(max+1);
+        int counter = 0;
+        for (size_t p = used.find_first(); p != bitset::npos; p = used.find_next(p)) {
+            if (p != 0) {
+                counter++;
+                if ((counter&1) != (int)(p&1)) counter++;
+            }
+            map[p] = counter;
+        }
+
+        job.map = map.data();
+        job.result = out;
+        job.phase = renumber_job::REMAP;
+        RUN(renumber_blocks, &job, 0, n_blocks);
+        return;
+    }
+
+    // sparse priorities: radix sort the pairs on the bytes that are not the same for all priorities
+    std::vector<renumber_pair> pairs(n), tmp(n);
+    std::vector<size_t> counts(256*n_blocks);
+    job.in = pairs.data();
+    job.phase = renumber_job::INIT;
+    RUN(renumber_blocks, &job, 0, n_blocks);
+
+    job.counts = counts.data();
+    for (int shift=0; shift<64; shift+=8) {
+        if (((diff >> shift) & 255) == 0) continue;
+        job.out = job.in == pairs.data() ? tmp.data() : pairs.data();
+        job.shift = shift;
+        job.phase = renumber_job::HISTOGRAM;
+        RUN(renumber_blocks, &job, 0, n_blocks);
+
+        // turn the counters into offsets, ordered by digit and then by block
+        size_t offset = 0;
+        for (int d=0; d<256; d++) {
+            for (size_t b=0; b<n_blocks; b++) {
+                const size_t c = counts[256*b+d];
+                counts[256*b+d] = offset;
+                offset += c;
+            }
+        }
+
+        job.phase = renumber_job::SCATTER;
+        RUN(renumber_blocks, &job, 0, n_blocks);
+        job.in = job.out;
+    }
+
+    // assign the numbers in order
+    int counter = 0;
+    uint64_t previous = 0;
+    for (size_t i=0; i<n; i++) {
+        const renumber_pair &pair = job.in[i];
+        if (previous != pair.priority) {
+            counter++;
+            if ((counter&1) != (int)(pair.priority&1)) counter++;
+            previous = pair.priority;
+        }
+        out[pair.vertex] = counter;
+    }
+}
+
+/**
+ * Renumber the given priorities, and write the result to <out>.
+ */
+static void
+renumber_priorities(const uint64_t *priority, size_t n, int *out)
+{
+    if (n == 0) return;
+    if (lace_workers() != 0 and n >= (1UL << 16)) return renumber_priorities_par(priority, n, out);
+
+    const uint64_t max = *std::max_element(priority, priority+n);
+    if (max < 4*n + 1024) {
+        // dense priorities: mark the used priorities and assign the numbers in a single sweep
+        std::vector<int> map(max+1, -1);
+        for (size_t v=0; v<n; v++) map[priority[v]] = 0;
+        int counter = 0;
+        for (uint64_t p=1; p<=max; p++) {
+            if (map[p] == -1) continue;
+            counter++;
+            if ((counter&1) != (int)(p&1)) counter++;
+            map[p] = counter;
+        }
+        for (size_t v=0; v<n; v++) out[v] = map[priority[v]];
+    } else {
+        // sparse priorities: sort the distinct priorities and use binary search
+        std::vector<uint64_t> keys(priority, priority+n);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<int> values(keys.size());
+        int counter = 0;
+        uint64_t previous = 0;
+        for (size_t i=0; i<keys.size(); i++) {
+            if (previous != keys[i]) {
+                counter++;
+                if ((counter&1) != (int)(keys[i]&1)) counter++;
+                previous = keys[i];
+            }
+            values[i] = counter;
+        }
+        for (size_t v=0; v<n; v++) {
+            out[v] = values[std::lower_bound(keys.begin(), keys.end(), priority[v]) - keys.begin()];
+        }
+    }
+}
+
 Game
 PGParser::parse_pgsolver(std::istream &inp, bool removeBadLoops)
 {
@@ -169,12 +404,13 @@ PGParser::parse_pgsolver(std::istream &inp, bool removeBadLoops)
             if (ch == ',') continue; // next successor
             if (ch == ';') break; // end of line
             if (ch == '\"') {
-                res._label[id] = new std::string();
+                std::string label;
                 while (true) {
                     inp >> ch;
                     if (ch == '\"') break;
-                    *res._label[id] += ch;
+                    label += ch;
                 }
+                res.set_label(id, label);
                 // now read ;
                 skip_whitespace(rd);
                 if (!(inp >> ch) or ch != ';') throw std::runtime_error("missing ; to end line");
@@ -490,28 +726,941 @@ PGParser::parse_pgsolver_renumber(std::istream &in, bool removeBadLoops)
     }
 
     // we now need to fix the priorities first...
-    boost::container::flat_map<uint64_t, int> map;
-    for (const auto& entry : priority) {
-        map[entry] = -1;
+    std::vector<int> int_priorities(node_count);
+    renumber_priorities(priority.data(), node_count, int_priorities.data());
+
+    Game res(node_count, edge_count, int_priorities, owner, edges, labels);
+    for (auto label : labels) delete label; // (copied to the label arena)
+    return res;
+}
+
+/**
+ * Helper functions for parsing a PGSolver format parity game from a memory buffer.
+ * These work on a pointer <p> into the buffer that ends at <end>.
+ */
+
+static inline void
+skip_whitespace(const char *&p, const char *end)
+{
+    while (p != end and (*p == ' ' or *p == '\n' or *p == '\t' or *p == '\r')) p++;
+}
+
+static inline bool
+is_digit(char ch)
+{
+    return (unsigned char)(ch - '0') <= 9;
+}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/**
+ * SWAR: return the number of consecutive digits at the start of the 8 bytes in <chunk>.
+ * A byte is a digit iff its high nibble is 3 and adding 6 does not change the high nibble.
+ */
+static inline int
+swar_count_digits(uint64_t chunk)
+{
+    uint64_t t = (chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4);
+    t ^= 0x3333333333333333ULL; // zero bytes are digits
+    return t == 0 ? 8 : (__builtin_ctzll(t) >> 3);
+}
+
+/**
+ * SWAR: convert the first <n> digits (1..8) of <chunk> to an integer.
+ */
+static inline uint64_t
+swar_parse_digits(uint64_t chunk, int n)
+{
+    uint64_t val = (chunk & 0x0F0F0F0F0F0F0F0FULL) << (8*(8-n)); // shifting in leading zeroes
+    val = (val * 10 + (val >> 8)) & 0x00FF00FF00FF00FFULL;
+    val = (val * 100 + (val >> 16)) & 0x0000FFFF0000FFFFULL;
+    return (val * 10000 + (val >> 32)) & 0x00000000FFFFFFFFULL;
+}
+#endif
+
+static bool
+read_uint64(const char *&p, const char *end, uint64_t *res)
+{
+    if (p == end or !is_digit(*p)) return false;
+    uint64_t r = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    static const uint64_t pow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+    while (end - p >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, p, 8);
+        const int n = swar_count_digits(chunk);
+        if (n == 0) break;
+        r = r * pow10[n] + swar_parse_digits(chunk, n);
+        p += n;
+        if (n != 8) {
+            *res = r;
+            return true;
+        }
     }
+#endif
+    while (p != end and is_digit(*p)) r = (10*r)+(*p++-'0');
+    *res = r;
+    return true;
+}
 
-    int counter = 0;
-    uint64_t previous = 0;
-    for (auto& pair : map) {
-        if (previous != pair.first) {
-            counter++;
-            if ((counter&1) != (pair.first&1)) counter++;
-            previous = pair.first;
+/**
+ * Read the header of a pgsolver game, i.e., "parity" <n> ";" and the optional "start" line.
+ * Returns the number <n> and moves <p> to the first vertex.
+ */
+static uint64_t
+read_header(const char *&p, const char *end)
+{
+    uint64_t n;
+
+    /**
+     * Read header line... one of the following:
+     * "parity" <number of vertices> ;
+     * "parity" <highest vertex id> ;
+     */
+
+    if (end - p < 6 or strncmp(p, "parity", 6) != 0) throw std::runtime_error("expecting parity game specification");
+    p += 6;
+
+    skip_whitespace(p, end);
+    if (!read_uint64(p, end, &n)) throw std::runtime_error("missing number of nodes");
+    if (n >= INT_MAX) throw std::runtime_error("too many nodes"); // the game has at most INT_MAX vertices
+
+    skip_whitespace(p, end);
+    if (p == end or *p++ != ';') throw std::runtime_error("missing ';'");
+
+    // check if next token is 'start'
+    // that means "start" <initial vertex id> ";"
+    // which we ignore...
+    skip_whitespace(p, end);
+    if (p != end and *p == 's') {
+        while (p != end and *p != '\n' and *p != '\r') p++;
+        if (p != end) p++;
+    }
+
+    return n;
+}
+
+/**
+ * Read the remainder of a vertex line after the vertex id: priority, owner, successors and the optional label.
+ * Calls add(to) for every successor that is kept and returns the number of kept successors.
+ * If the vertex has a label, then <label> and <label_end> are set to the label contents in the buffer.
+ */
+template <typename AddEdge>
+static inline int
+read_vertex(const char *&p, const char *end, uint64_t id, uint64_t n_vertices, bool removeBadLoops,
+            uint64_t *priority, bool *owner, const char **label, const char **label_end, AddEdge add)
+{
+    uint64_t n;
+
+    skip_whitespace(p, end);
+    if (!read_uint64(p, end, &n)) throw std::runtime_error("missing priority");
+    *priority = n;
+
+    skip_whitespace(p, end);
+    if (!read_uint64(p, end, &n)) throw std::runtime_error("missing owner");
+
+    if (n == 1) *owner = true;
+    else if (n == 0) *owner = false;
+    else throw std::runtime_error("invalid owner (must be 0 or 1)");
+
+    const bool bad_loop = removeBadLoops and (*owner != (*priority&1));
+    bool has_self = false;
+    int count = 0;
+
+    *label = nullptr;
+
+    // parse successors and optional label
+    for (;;) {
+        skip_whitespace(p, end);
+        if (!read_uint64(p, end, &n)) throw std::runtime_error("missing successor");
+        if (n >= n_vertices) {
+            std::stringstream err;
+            err << "invalid successor for id " << id;
+            throw std::runtime_error(err.str());
+        }
+
+        if (id == n and bad_loop) {
+            has_self = true;
+        } else {
+            // add edge
+            add((int)n);
+            count++;
+        }
+
+        skip_whitespace(p, end);
+        if (p == end) throw std::runtime_error("missing ; to end line");
+        const char ch = *p++;
+        if (ch == ',') continue; // next successor
+        if (ch == ';') break; // end of line
+        if (ch == '\"') {
+            const char *q = (const char*)memchr(p, '\"', end - p);
+            if (q == nullptr) throw std::runtime_error("missing ; to end line");
+            *label = p;
+            *label_end = q;
+            p = q + 1;
+            // now read ;
+            skip_whitespace(p, end);
+            if (p == end or *p++ != ';') throw std::runtime_error("missing ; to end line");
         }
-        pair.second = counter;
+        break;
     }
 
-    std::vector<int> int_priorities(node_count);
-    for (unsigned v=0; v<node_count; v++) {
-        int_priorities[v] = map[priority[v]];
+    if (has_self and count == 0) {
+        // we must keep it
+        add((int)id);
+        count++;
     }
 
-    return { node_count, edge_count, int_priorities, owner, edges, labels };
+    return count;
+}
+
+static size_t parallel_parse = 1UL << 20; // smaller buffers are parsed sequentially (see set_parallel_parse)
+
+void
+PGParser::set_parallel_parse(size_t bytes)
+{
+    parallel_parse = bytes;
+}
+
+size_t
+PGParser::get_parallel_parse(void)
+{
+    return parallel_parse;
+}
+
+Game
+PGParser::parse_pgsolver_buffer(const char *data, size_t size, bool removeBadLoops, label_mode labels, std::vector<int> *mapping)
+{
+    // only parse in parallel if Lace is running and there is enough to parse
+    if (lace_workers() != 0 and size >= parallel_parse) return parse_pgsolver_buffer_par(data, size, removeBadLoops, labels, nullptr, mapping);
+    else return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, nullptr, mapping);
+}
+
+/**
+ * The buffer parsers take the mapped file that contains the buffer (or nullptr) for LABELS_MAPPED.
+ * Labels are then stored as offsets into the mapping; without a mapped file, labels are copied.
+ */
+
+Game
+PGParser::parse_pgsolver_buffer_seq(const char *data, size_t size, bool removeBadLoops, label_mode labels, const std::shared_ptr<MappedFile> &file, std::vector<int> *mapping)
+{
+    if (labels == LABELS_MAPPED and file == nullptr) labels = LABELS_COPY;
+
+    const char *p = data;
+    const char *end = data + size;
+
+    // the given number is either the number of vertices, or the highest vertex
+    // so, we expect n or n+1 nodes
+    unsigned long n_vertices = read_header(p, end) + 1;
+
+    /**
+     * Construct game...
+     * Every edge is followed by a ',' or a ';' so counting those gives an upper bound on the number of edges.
+     */
+
+    const size_t e_bound = std::count(p, end, ',') + std::count(p, end, ';');
+
+    Game res(n_vertices, std::min(e_bound, Game::EDGE_OFFSET_MAX/2));
+    std::vector<uint64_t> priority(n_vertices);
+    bitset seen(n_vertices);
+
+    int *outedges = res._outedges;
+    size_t e_size = res.e_size;
+    auto add = [&] (int to) {
+        if (e_size == res.e_allocated) { res.e_sizeup(); outedges = res._outedges; }
+        outedges[e_size++] = to;
+    };
+
+    /**
+     * Parse the nodes...
+     */
+
+    size_t node_count = 0; // number of read nodes
+    size_t edge_count = 0; // number of read edges
+
+    while (node_count < n_vertices) {
+        uint64_t id;
+        skip_whitespace(p, end);
+        if (!read_uint64(p, end, &id)) {
+            // we expect maybe one more node...
+            if (node_count == n_vertices - 1 && !seen[n_vertices - 1]) {
+                n_vertices -= 1;
+                seen.resize(n_vertices);
+                // ignore rest, they can be bigger
+                break;
+            } else {
+                throw std::runtime_error("unable to read id");
+            }
+        }
+        if (id >= n_vertices) throw std::runtime_error("invalid id (too high)");
+        if (seen[id]) throw std::runtime_error("duplicate id");
+        seen[id] = true;
+        node_count++;
+
+        bool owner;
+        const char *label = nullptr, *label_end = nullptr;
+        res._firstouts[id] = e_size;
+        const int count = read_vertex(p, end, id, n_vertices, removeBadLoops, &priority[id], &owner, &label, &label_end, add);
+        add(-1);
+        res._outcount[id] = count;
+        edge_count += count;
+        if (owner) res._owner[id] = true;
+        if (label != nullptr and label != label_end and labels != LABELS_NONE) {
+            if (labels == LABELS_MAPPED) {
+                res._label[id] = Game::label_ref(label - data, label_end - label);
+                res._label_file = file;
+            } else {
+                if (res._label_arena == nullptr) res._label_arena = std::make_shared<std::string>();
+                res._label[id] = Game::label_ref(res._label_arena->size(), label_end - label);
+                res._label_arena->append(label, label_end);
+            }
+        }
+    }
+
+    if (!seen.all()) {
+        std::stringstream err;
+        err << "missing nodes, seen only " << seen.count();
+        throw std::runtime_error(err.str());
+    }
+
+    res.v_resize(n_vertices);
+    res.e_size = e_size;
+    res.n_edges = edge_count;
+
+    // we now need to fix the priorities...
+    renumber_priorities(priority.data(), n_vertices, res._priority);
+
+    // check if ordered...
+    res.is_ordered = true;
+    for (unsigned long i=1; i<n_vertices; i++) {
+        if (res._priority[i-1] > res._priority[i]) {
+            res.is_ordered = false;
+            break;
+        }
+    }
+
+    if (mapping != nullptr) order_parsed(res, *mapping);
+
+    return res;
+}
+
+/**
+ * A chunk of vertex lines for the parallel parser.
+ * Each worker parses a chunk into the local buffers, which are then copied to the game.
+ */
+struct pg_chunk
+{
+    const char *begin, *end;             // the part of the input buffer
+    std::vector<int> ids;                // vertex ids, in order of the input
+    std::vector<uint64_t> priorities;    // priority of each vertex
+    std::vector<char> owners;            // owner of each vertex
+    std::vector<int> counts;             // number of successors of each vertex
+    std::vector<const char*> labels;     // label start and end of each vertex (or nullptr, nullptr)
+    std::vector<int> edges;              // successors of all vertices
+    size_t offset;                       // where the edges start in the edge array
+    size_t label_size;                   // total length of the labels
+    size_t label_offset;                 // where the labels start in the label arena
+    bool failed;                         // set if any error was encountered
+};
+
+/**
+ * The arrays of the game that the parallel parser writes to.
+ */
+struct pg_target
+{
+    uint64_t n_vertices;
+    bool removeBadLoops;
+    int *outedges;
+    edge_t *firstouts;
+    int *outcount;
+    uint64_t *priority;
+    uint64_t *label;         // label of each vertex (see Game::label_ref)
+    int label_mode;          // PGParser::label_mode
+    const char *data;        // start of the buffer (for LABELS_MAPPED)
+    char *arena;             // the label arena (for LABELS_COPY)
+    size_t max_label;        // longest allowed label
+    int label_bits;          // the label reference has the offset shifted by <label_bits> and the length
+    bitset *owner;
+    bitset *seen;
+    volatile bool duplicate;
+};
+
+static void
+parse_chunk(pg_chunk *c, pg_target *t)
+{
+    c->failed = false;
+    c->label_size = 0;
+    const char *p = c->begin;
+    const char *end = c->end;
+    auto add = [&] (int to) { c->edges.push_back(to); };
+    try {
+        for (;;) {
+            uint64_t id;
+            skip_whitespace(p, end);
+            if (p == end) break;
+            if (!read_uint64(p, end, &id) or id >= t->n_vertices) { c->failed = true; return; }
+            uint64_t priority;
+            bool owner;
+            const char *label = nullptr, *label_end = nullptr;
+            c->counts.push_back(read_vertex(p, end, id, t->n_vertices, t->removeBadLoops, &priority, &owner, &label, &label_end, add));
+            c->ids.push_back(id);
+            c->priorities.push_back(priority);
+            c->owners.push_back(owner);
+            if (label == nullptr or t->label_mode == PGParser::LABELS_NONE) label = label_end = nullptr;
+            else if ((size_t)(label_end - label) > t->max_label) { c->failed = true; return; }
+            else c->label_size += label_end - label;
+            c->labels.push_back(label);
+            c->labels.push_back(label_end);
+        }
+    } catch (std::runtime_error&) {
+        c->failed = true;
+    }
+}
+
+static void
+fill_chunk(pg_chunk *c, pg_target *t)
+{
+    size_t pos = c->offset;
+    size_t label_pos = c->label_offset;
+    const int *edge = c->edges.data();
+    for (size_t i=0; i<c->ids.size(); i++) {
+        const int id = c->ids[i];
+        if (t->seen->atomic_set(id)) {
+            t->duplicate = true;
+            return;
+        }
+        const int count = c->counts[i];
+        t->firstouts[id] = pos;
+        t->outcount[id] = count;
+        memcpy(t->outedges + pos, edge, sizeof(int[count]));
+        edge += count;
+        pos += count;
+        t->outedges[pos++] = -1;
+        t->priority[id] = c->priorities[i];
+        if (c->owners[i]) t->owner->atomic_set(id);
+        const char *label = c->labels[2*i];
+        const char *label_end = c->labels[2*i+1];
+        if (label != label_end) {
+            const size_t len = label_end - label;
+            if (t->label_mode == PGParser::LABELS_MAPPED) {
+                t->label[id] = ((uint64_t)(label - t->data) << t->label_bits) | len;
+            } else {
+                memcpy(t->arena + label_pos, label, len);
+                t->label[id] = ((uint64_t)label_pos << t->label_bits) | len;
+                label_pos += len;
+            }
+        }
+    }
+    // release the local buffers
+    std::vector<int>().swap(c->edges);
+}
+
+VOID_TASK_4(parse_chunks, pg_chunk*, chunks, int, count, pg_target*, t, bool, fill)
+{
+    if (count == 1) {
+        if (fill) fill_chunk(chunks, t);
+        else parse_chunk(chunks, t);
+    } else {
+        SPAWN(parse_chunks, chunks+count/2, count-count/2, t, fill);
+        CALL(parse_chunks, chunks, count/2, t, fill);
+        SYNC(parse_chunks);
+    }
+}
+
+Game
+PGParser::parse_pgsolver_buffer_par(const char *data, size_t size, bool removeBadLoops, label_mode labels, std::vector<int> *mapping)
+{
+    return parse_pgsolver_buffer_par(data, size, removeBadLoops, labels, nullptr, mapping);
+}
+
+Game
+PGParser::parse_pgsolver_buffer_par(const char *data, size_t size, bool removeBadLoops, label_mode labels, const std::shared_ptr<MappedFile> &file, std::vector<int> *mapping)
+{
+    if (lace_workers() == 0) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+    if (labels == LABELS_MAPPED and file == nullptr) labels = LABELS_COPY;
+
+    const char *p = data;
+    const char *end = data + size;
+
+    // the given number is either the number of vertices, or the highest vertex
+    // so, we expect n or n+1 nodes
+    const unsigned long n_vertices = read_header(p, end) + 1;
+
+    /**
+     * Split the remaining buffer into chunks, each ending after a ';' that ends a vertex line.
+     * We assume that a ';' followed by whitespace is not inside a label; if that assumption is wrong,
+     * then parsing a chunk fails and we use the sequential parser instead.
+     */
+
+    const size_t chunk_size = std::max({(size_t)(end-p) / (8*lace_workers()), parallel_parse / 4, (size_t)1});
+    std::vector<pg_chunk> chunks;
+    while (p != end) {
+        const char *q = (size_t)(end-p) <= chunk_size ? end : p + chunk_size;
+        while (q != end) {
+            q = (const char*)memchr(q, ';', end-q);
+            if (q == nullptr) q = end;
+            else if (++q == end or *q == '\n' or *q == '\r' or *q == ' ' or *q == '\t') break;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = p;
+        chunks.back().end = q;
+        p = q;
+    }
+    if (chunks.empty()) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+
+    pg_target t;
+    t.n_vertices = n_vertices;
+    t.removeBadLoops = removeBadLoops;
+    t.duplicate = false;
+    t.label_mode = labels;
+    t.data = data;
+    t.arena = nullptr;
+    t.label_bits = Game::LABEL_LENGTH_BITS;
+    // (offsets must fit in the label reference, otherwise the sequential parser reports the error)
+    t.max_label = size < (size_t(1) << (64-Game::LABEL_LENGTH_BITS)) ? Game::LABEL_LENGTH_MASK : 0;
+
+    // parse all chunks in parallel
+    RUN(parse_chunks, chunks.data(), chunks.size(), &t, false);
+
+    // prefix sum of the number of edges (with the -1 after every vertex) and the labels of each chunk
+    size_t node_count = 0, edge_count = 0;
+    size_t offset = 1; // the edge array starts with -1
+    size_t label_size = 0;
+    for (auto &c : chunks) {
+        if (c.failed) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+        c.offset = offset;
+        offset += c.edges.size() + c.ids.size();
+        c.label_offset = label_size;
+        label_size += c.label_size;
+        node_count += c.ids.size();
+        edge_count += c.edges.size();
+    }
+
+    // we expect n or n+1 nodes; anything else is an error that the sequential parser reports
+    if (node_count != n_vertices and node_count != n_vertices - 1) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+
+    // the last position in the edge array must fit in edge_t
+    if (offset - 1 > Game::EDGE_OFFSET_MAX) throw std::runtime_error("too many edges");
+
+    Game res(n_vertices, 1);
+    free(res._outedges);
+    res.e_allocated = offset;
+    res._outedges = (int*)alloc_array(sizeof(int[offset]));
+    if (res._outedges == (int*)0) abort();
+    res._outedges[0] = -1;
+
+    std::vector<uint64_t> priority(n_vertices);
+    bitset seen(n_vertices);
+
+    t.outedges = res._outedges;
+    t.firstouts = res._firstouts;
+    t.outcount = res._outcount;
+    t.priority = priority.data();
+    t.label = res._label;
+    if (label_size != 0) {
+        if (labels == LABELS_MAPPED) {
+            res._label_file = file;
+        } else {
+            res._label_arena = std::make_shared<std::string>(label_size, '\0');
+            t.arena = &(*res._label_arena)[0];
+        }
+    }
+    t.owner = &res._owner;
+    t.seen = &seen;
+
+    // copy all chunks to the game in parallel
+    RUN(parse_chunks, chunks.data(), chunks.size(), &t, true);
+
+    // report duplicate ids and missing nodes via the sequential parser
+    if (t.duplicate) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+    if (node_count != n_vertices) {
+        if (seen[n_vertices-1]) return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+        res.v_resize(node_count);
+    }
+
+    res.e_size = offset;
+    res.n_edges = edge_count;
+
+    // we now need to fix the priorities...
+    renumber_priorities(priority.data(), node_count, res._priority);
+
+    // check if ordered...
+    res.is_ordered = true;
+    for (unsigned long i=1; i<node_count; i++) {
+        if (res._priority[i-1] > res._priority[i]) {
+            res.is_ordered = false;
+            break;
+        }
+    }
+
+    if (mapping != nullptr) order_parsed(res, *mapping);
+
+    return res;
+}
+
+/**
+ * Order a freshly parsed game (without a solution) by priority and build the in-edges.
+ * The priorities are renumbered by the parser, so they are at most about twice the number of vertices,
+ * and the new position of every vertex is found with a stable counting sort. Then a single pass over
+ * the edges writes the out-edges and the in-edges directly to their final positions, instead of sorting
+ * a mapping, permuting the game in place and building the in-edges afterwards.
+ */
+void
+PGParser::order_parsed(Game &game, std::vector<int> &mapping)
+{
+    const int n = game.n_vertices;
+    mapping.resize(n);
+
+    if (game.is_ordered) {
+        for (int v=0; v<n; v++) mapping[v] = v;
+        game.build_in_array(false);
+        return;
+    }
+
+    // counting sort of the vertices by priority
+    const int max = *std::max_element(game._priority, game._priority+n);
+    std::vector<int> start(max+1, 0);
+    for (int v=0; v<n; v++) start[game._priority[v]]++;
+    for (int p=0, sum=0; p<=max; p++) {
+        const int count = start[p];
+        start[p] = sum;
+        sum += count;
+    }
+    std::vector<int> pos(n);
+    for (int v=0; v<n; v++) {
+        pos[v] = start[game._priority[v]]++;
+        mapping[pos[v]] = v;
+    }
+
+    // count the in-edges of every vertex
+    std::vector<int> indeg(n, 0);
+    for (size_t i=0; i<game.e_size; i++) {
+        if (game._outedges[i] != -1) indeg[game._outedges[i]]++;
+    }
+
+    int *priority = (int*)alloc_array(sizeof(int[game.v_allocated]));
+    edge_t *firstouts = (edge_t*)alloc_array(sizeof(edge_t[game.v_allocated]));
+    int *outcount = (int*)alloc_array(sizeof(int[game.v_allocated]));
+    uint64_t *label = (uint64_t*)calloc_array(sizeof(uint64_t[game.v_allocated]));
+    int *outedges = (int*)alloc_array(sizeof(int[game.e_size]));
+    if (priority == (int*)0) abort();
+    if (firstouts == (edge_t*)0) abort();
+    if (outcount == (int*)0) abort();
+    if (label == (uint64_t*)0) abort();
+    if (outedges == (int*)0) abort();
+    bitset owner(n);
+
+    int *inedges = (int*)alloc_array(sizeof(int[game.e_size]));
+    edge_t *firstins = (edge_t*)alloc_array(sizeof(edge_t[n]));
+    int *incount = (int*)alloc_array(sizeof(int[n]));
+    if (inedges == (int*)0 or firstins == (edge_t*)0 or incount == (int*)0) abort();
+
+    // the in-edges of every vertex are written backwards from the end of its list (as in build_in_array)
+    size_t in_pos = 0;
+    for (int u=0; u<n; u++) {
+        incount[u] = indeg[mapping[u]];
+        firstins[u] = in_pos + incount[u];
+        inedges[firstins[u]] = -1;
+        in_pos += incount[u] + 1;
+    }
+
+    size_t out_pos = 0;
+    outedges[out_pos++] = -1;
+    for (int u=0; u<n; u++) {
+        const int v = mapping[u];
+        priority[u] = game._priority[v];
+        if (game._owner[v]) owner.set(u);
+        label[u] = game._label[v];
+        firstouts[u] = out_pos;
+        outcount[u] = game._outcount[v];
+        for (const int *e = game._outedges + game._firstouts[v]; *e != -1; e++) {
+            const int to = pos[*e];
+            outedges[out_pos++] = to;
+            inedges[--firstins[to]] = u;
+        }
+        outedges[out_pos++] = -1;
+    }
+
+    free(game._priority);
+    free(game._firstouts);
+    free(game._outcount);
+    free(game._label);
+    free(game._outedges);
+    game._priority = priority;
+    game._firstouts = firstouts;
+    game._outcount = outcount;
+    game._label = label;
+    game._outedges = outedges;
+    game._owner.swap(owner);
+    game._inedges = inedges;
+    game._firstins = firstins;
+    game._incount = incount;
+    game.e_allocated = game.e_size;
+    game.is_ordered = true;
+}
+
+Game
+PGParser::parse_pgsolver_file(const std::string &filename, bool removeBadLoops, label_mode labels, std::vector<int> *mapping)
+{
+    auto file = std::make_shared<MappedFile>(filename);
+    file->sequential();
+    const char *data = file->data() != NULL ? file->data() : "";
+    const size_t size = file->size();
+    if (lace_workers() != 0 and size >= parallel_parse) return parse_pgsolver_buffer_par(data, size, removeBadLoops, labels, file, mapping);
+    else return parse_pgsolver_buffer_seq(data, size, removeBadLoops, labels, file, mapping);
+}
+
+/**
+ * Check the arrays of a binary game, which are used as they are in the file, so a damaged file
+ * cannot make the solvers read outside the arrays. Every list of edges must be inside the edge
+ * array and end with -1, every edge must go to a vertex of the game, the in-edges must match the
+ * out-edges, and the priorities must be sorted if the game is marked as ordered.
+ */
+void
+PGParser::validate_binary(const Game &game, uint64_t n_edges)
+{
+    const int n = game.n_vertices;
+    const uint64_t e_size = game.e_size;
+    const uint64_t in_size = n + n_edges;
+
+    std::vector<int> indeg(n, 0);
+    uint64_t out_total = 0;
+    for (int v=0; v<n; v++) {
+        if (game._priority[v] < 0) throw std::runtime_error("invalid priority");
+        if (game.is_ordered and v > 0 and game._priority[v-1] > game._priority[v]) throw std::runtime_error("binary parity game is not ordered");
+        const edge_t first = game._firstouts[v];
+        const int count = game._outcount[v];
+        if (first < 0 or count < 0 or (uint64_t)first + count >= e_size) throw std::runtime_error("invalid edge list");
+        const int *e = game._outedges + first;
+        if (e[count] != -1) throw std::runtime_error("invalid edge list");
+        for (int i=0; i<count; i++) {
+            if (e[i] < 0 or e[i] >= n) throw std::runtime_error("invalid edge");
+            indeg[e[i]]++;
+        }
+        out_total += count;
+    }
+    if (out_total != n_edges) throw std::runtime_error("invalid number of edges");
+
+    if (game._inedges == NULL) return;
+    for (int v=0; v<n; v++) {
+        const edge_t first = game._firstins[v];
+        const int count = game._incount[v];
+        if (first < 0 or count != indeg[v] or (uint64_t)first + count >= in_size) throw std::runtime_error("invalid edge list");
+        const int *e = game._inedges + first;
+        if (e[count] != -1) throw std::runtime_error("invalid edge list");
+        for (int i=0; i<count; i++) {
+            if (e[i] < 0 or e[i] >= n) throw std::runtime_error("invalid edge");
+        }
+    }
+}
+
+Game
+PGParser::parse_binary_file(const std::string &filename, label_mode labels)
+{
+    typedef Game::binary_header header;
+
+    // map the file writable (but private) so transformations can modify the arrays in place
+    auto file = std::make_shared<MappedFile>(filename, true);
+    char *data = file->data();
+    const size_t size = file->size();
+
+    header hdr;
+    if (size < sizeof(header)) throw std::runtime_error("expecting binary parity game");
+    memcpy(&hdr, data, sizeof(header));
+    if (memcmp(hdr.magic, header::MAGIC, sizeof(hdr.magic)) != 0) throw std::runtime_error("expecting binary parity game");
+    if (hdr.endian != header::ENDIAN) throw std::runtime_error("binary parity game has wrong byte order");
+    if (hdr.version != header::VERSION) throw std::runtime_error("unsupported version of binary parity game");
+
+    const uint64_t n = hdr.n_vertices;
+    if (n == 0 or n > INT_MAX) throw std::runtime_error("invalid number of vertices");
+    if (hdr.e_size < n + hdr.n_edges) throw std::runtime_error("invalid number of edges");
+    if (hdr.e_size - 1 > Game::EDGE_OFFSET_MAX) throw std::runtime_error("too many edges");
+
+    // locate the sections, each starts at a multiple of 64 bytes
+    size_t pos = sizeof(header);
+    auto section = [&] (size_t len) {
+        pos = (pos + 63) & ~size_t(63);
+        if (pos > size or len > size - pos) throw std::runtime_error("binary parity game is truncated");
+        char *res = data + pos;
+        pos += len;
+        return res;
+    };
+
+    Game res;
+    res.n_vertices = n;
+    res.n_edges = hdr.n_edges;
+    res.e_size = hdr.e_size;
+    res.v_allocated = n;
+    res.e_allocated = hdr.e_size;
+    res.is_ordered = (hdr.flags & header::FLAG_ORDERED) != 0;
+    res._mapped = file;
+
+    res._label = (uint64_t*)calloc_array(sizeof(uint64_t[n]));
+    if (res._label == (uint64_t*)0) abort();
+    res.strategy = (int*)alloc_array(sizeof(int[n]));
+    if (res.strategy == (int*)0) abort();
+    std::fill(res.strategy, res.strategy+n, -1);
+    res.solved = bitset(n);
+    res.winner = bitset(n);
+
+    res._priority = (int*)section(sizeof(int[n]));
+    res._owner = bitset(n);
+    memcpy(res._owner.data(), section(sizeof(uint64_t[(n+63)/64])), sizeof(uint64_t[(n+63)/64]));
+    // the edge positions are used in place if they have the width of edge_t, otherwise they are converted
+    const bool edge64 = (hdr.flags & header::FLAG_EDGE64) != 0;
+    auto edge_offsets = [&] () {
+        if (edge64 == (sizeof(edge_t) == 8)) return (edge_t*)section(sizeof(edge_t[n]));
+        edge_t *res = (edge_t*)alloc_array(sizeof(edge_t[n]));
+        if (res == (edge_t*)0) abort();
+        if (edge64) {
+            const int64_t *src = (const int64_t*)section(sizeof(int64_t[n]));
+            std::copy(src, src+n, res);
+        } else {
+            const int32_t *src = (const int32_t*)section(sizeof(int32_t[n]));
+            std::copy(src, src+n, res);
+        }
+        return res;
+    };
+
+    res._firstouts = edge_offsets();
+    res._outcount = (int*)section(sizeof(int[n]));
+    res._outedges = (int*)section(sizeof(int[hdr.e_size]));
+
+    if (hdr.flags & header::FLAG_INEDGES) {
+        res._firstins = edge_offsets();
+        res._incount = (int*)section(sizeof(int[n]));
+        res._inedges = (int*)section(sizeof(int[n + hdr.n_edges]));
+    }
+
+    validate_binary(res, hdr.n_edges);
+
+    if ((hdr.flags & header::FLAG_LABELS) and labels != LABELS_NONE) {
+        const uint64_t *offsets = (const uint64_t*)section(sizeof(uint64_t[n+1]));
+        const char *blob = section(hdr.label_size);
+        for (uint64_t i=0; i<n; i++) {
+            if (offsets[i] > offsets[i+1] or offsets[i+1] > hdr.label_size) throw std::runtime_error("invalid label");
+            if (offsets[i+1] - offsets[i] > Game::LABEL_LENGTH_MASK) throw std::runtime_error("label too long");
+        }
+        if (labels == LABELS_MAPPED) {
+            // refer to the blob in the mapping
+            const size_t base = blob - data;
+            for (uint64_t i=0; i<n; i++) res._label[i] = Game::label_ref(base + offsets[i], offsets[i+1] - offsets[i]);
+            res._label_file = file;
+        } else {
+            res._label_arena = std::make_shared<std::string>(blob, hdr.label_size);
+            for (uint64_t i=0; i<n; i++) res._label[i] = Game::label_ref(offsets[i], offsets[i+1] - offsets[i]);
+        }
+    }
+
+    return res;
+}
+
+/**
+ * Helpers for the compact format.
+ */
+
+static inline uint64_t
+read_varint(std::streambuf *rd)
+{
+    uint64_t res = 0;
+    for (int shift=0; shift<64; shift+=7) {
+        int ch = rd->sbumpc();
+        if (ch == EOF) throw std::runtime_error("unexpected end of compact parity game");
+        res |= (uint64_t)(ch & 0x7f) << shift;
+        if ((ch & 0x80) == 0) return res;
+    }
+    throw std::runtime_error("invalid number in compact parity game");
+}
+
+static inline int64_t
+read_zigzag(std::streambuf *rd)
+{
+    uint64_t v = read_varint(rd);
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+Game
+PGParser::parse_compact(std::istream &inp, label_mode labels)
+{
+    typedef Game::compact_format format;
+    std::streambuf *rd = inp.rdbuf();
+
+    char magic[sizeof(format::MAGIC)];
+    if (rd->sgetn(magic, sizeof(magic)) != sizeof(magic) or memcmp(magic, format::MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("expecting compact parity game");
+    }
+    if (read_varint(rd) != format::VERSION) throw std::runtime_error("unsupported version of compact parity game");
+    const uint64_t flags = read_varint(rd);
+    const uint64_t n = read_varint(rd);
+    const uint64_t m = read_varint(rd);
+    if (n == 0 or n > INT_MAX) throw std::runtime_error("invalid number of vertices");
+    if (m > Game::EDGE_OFFSET_MAX - n) throw std::runtime_error("too many edges");
+
+    Game res(n, m);
+
+    // priorities
+    int64_t last = 0;
+    for (uint64_t i=0; i<n;) {
+        int64_t prio = last + read_zigzag(rd);
+        uint64_t len = read_varint(rd);
+        if (prio < 0 or prio > INT_MAX) throw std::runtime_error("priority too high");
+        if (len == 0 or len > n-i) throw std::runtime_error("invalid run of priorities");
+        std::fill(res._priority+i, res._priority+i+len, (int)prio);
+        last = prio;
+        i += len;
+    }
+
+    // owners
+    for (uint64_t i=0; i<n; i+=8) {
+        int ch = rd->sbumpc();
+        if (ch == EOF) throw std::runtime_error("unexpected end of compact parity game");
+        for (uint64_t k=0; k<8 and i+k<n; k++) if (ch & (1<<k)) res._owner.set(i+k);
+    }
+
+    // successors
+    for (uint64_t v=0; v<n; v++) {
+        uint64_t count = read_varint(rd);
+        if (count > m - res.n_edges) throw std::runtime_error("too many edges");
+        res._firstouts[v] = res.e_size;
+        res._outcount[v] = count;
+        int64_t to = v;
+        for (uint64_t k=0; k<count; k++) {
+            int64_t delta = k == 0 ? read_zigzag(rd) : (int64_t)std::min(read_varint(rd), n);
+            if (delta < -to or delta >= (int64_t)n - to) throw std::runtime_error("invalid successor");
+            to += delta;
+            res._outedges[res.e_size++] = to;
+        }
+        res._outedges[res.e_size++] = -1;
+        res.n_edges += count;
+    }
+    if ((uint64_t)res.n_edges != m) throw std::runtime_error("wrong number of edges");
+    res.sorted_succs = true; // (the successors are stored in ascending order)
+
+    // labels
+    if (flags & format::FLAG_LABELS) {
+        // read the labels directly into the arena (or skip them)
+        auto arena = std::make_shared<std::string>();
+        for (uint64_t v=0; v<n; v++) {
+            uint64_t len = read_varint(rd);
+            if (len == 0) continue;
+            const uint64_t ref = Game::label_ref(arena->size(), len); // (also checks the length)
+            const size_t pos = arena->size();
+            arena->resize(pos + len);
+            if ((uint64_t)rd->sgetn(&(*arena)[pos], len) != len) throw std::runtime_error("unexpected end of compact parity game");
+            if (labels == LABELS_NONE) arena->clear();
+            else res._label[v] = ref;
+        }
+        if (!arena->empty()) res._label_arena = arena;
+    }
+
+    res.is_ordered = true;
+    for (uint64_t i=1; i<n; i++) {
+        if (res._priority[i-1] > res._priority[i]) {
+            res.is_ordered = false;
+            break;
+        }
+    }
+
+    return res;
 }
 
 }
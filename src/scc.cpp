@@ -15,11 +15,20 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <deque>
 #include <stack>
 #include <cstring> // for memset
+#include <memory>
+#include <queue>
+#include <sstream>
 #include "oink/oink.hpp"
+#include "oink/solver.hpp"
+#include "oink/subgame.hpp"
+#include "lace.h"
 
 namespace pg {
 
@@ -75,7 +84,7 @@ Oink::tarjan(int n, std::vector<int> &res, bool nonempty)
          */
 
         if (nonempty) {
-            if (res.back() == idx and !game->has_edge(idx, idx)) {
+            if (res.back() == idx and !game->has_selfloop(idx)) {
                 // it has no edges!
                 res.pop_back();
                 st.pop();
@@ -117,4 +126,423 @@ Oink::getBottomSCC(int start, std::vector<int> &scc, bool nonempty)
     tarjan(start, scc, nonempty);
 }
 
+
+/**
+ * The parallel search for winner-controlled winning cycles.
+ *
+ * The vertices of each player that are not disabled form a component, with only the edges between them.
+ * Every round, each component is split into SCCs with Tarjan's algorithm, in parallel for all components.
+ * An SCC with a cycle is won by the player if its highest priority has the parity of the player: every
+ * vertex is then on a cycle through the highest priority. Otherwise, the vertices with a priority above
+ * the highest priority of the player are on no winning cycle, and the rest of the SCC is a component of
+ * the next round. So a vertex is found iff it is on a winner-controlled winning cycle.
+ */
+typedef std::vector<int> wcwc_component;
+
+struct wcwc_search
+{
+    Game *game;
+    int64_t *comp;          // the component or SCC of every vertex, or -1
+    int *index;             // (Tarjan) the index of every vertex in the search, or 0 if not seen yet
+    int *low;               // (Tarjan) the lowest index reachable from every vertex
+    int *strategy;          // the strategy of every vertex on a winning cycle, or -1
+    int64_t next_id;        // the next free component number (updated atomically)
+    int64_t count;          // the number of winning SCCs (updated atomically)
+};
+
+/**
+ * Handle an SCC <scc> of player <pl> with number <id>: mark it as won, or add the next component to <next>.
+ */
+static void
+wcwc_scc(wcwc_search *s, const wcwc_component &scc, int64_t id, int pl, std::vector<wcwc_component> &next)
+{
+    Game *game = s->game;
+
+    if (scc.size() == 1 and !game->has_selfloop(scc[0])) {
+        // no cycle
+        s->comp[scc[0]] = -1;
+        return;
+    }
+
+    int max_pr = -1, max_pr_pl = -1, max_pr_n = -1;
+    for (int v : scc) {
+        const int d = game->priority(v);
+        if (d > max_pr) max_pr = d;
+        if ((d&1) == pl and d > max_pr_pl) {
+            max_pr_pl = d;
+            max_pr_n = v;
+        }
+    }
+
+    if ((max_pr & 1) == pl) {
+        // won by <pl>: set strategies towards the highest vertex via backward search
+        std::queue<int> q;
+        q.push(max_pr_n);
+        while (!q.empty()) {
+            const int cur = q.front();
+            q.pop();
+            for (int from : game->preds(cur)) {
+                if (s->comp[from] != id or s->strategy[from] != -1) continue;
+                s->strategy[from] = cur;
+                q.push(from);
+            }
+        }
+        __atomic_fetch_add(&s->count, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // remove the vertices above the highest priority of <pl>
+    wcwc_component rest;
+    const int64_t rest_id = __atomic_fetch_add(&s->next_id, 1, __ATOMIC_RELAXED);
+    for (int v : scc) {
+        if (game->priority(v) > max_pr_pl) {
+            s->comp[v] = -1;
+        } else {
+            s->comp[v] = rest_id;
+            rest.push_back(v);
+        }
+    }
+    if (!rest.empty()) next.push_back(std::move(rest));
+}
+
+/**
+ * Split the component <c> of player <pl> into SCCs (Tarjan), and add the components of the next round to <next>.
+ */
+static void
+wcwc_split(wcwc_search *s, const wcwc_component &c, int pl, std::vector<wcwc_component> &next)
+{
+    const Game *game = s->game;
+    const int64_t id = s->comp[c[0]];
+    for (int v : c) s->index[v] = 0;
+
+    int pre = 0;
+    std::vector<int> st;                             // the Tarjan stack
+    std::vector<std::pair<int, const int*>> calls;   // the DFS stack, with the next edge of every vertex
+
+    for (int root : c) {
+        if (s->index[root] != 0 or s->comp[root] != id) continue;
+        s->index[root] = s->low[root] = ++pre;
+        st.push_back(root);
+        calls.emplace_back(root, game->outs(root));
+
+        while (!calls.empty()) {
+            const int v = calls.back().first;
+            const int *&e = calls.back().second;
+            bool pushed = false;
+            for (int to = *e; to != -1; to = *++e) {
+                if (s->comp[to] != id) continue; // not (or no longer) in the component
+                if (s->index[to] == 0) {
+                    s->index[to] = s->low[to] = ++pre;
+                    st.push_back(to);
+                    calls.emplace_back(to, game->outs(to));
+                    pushed = true;
+                    break;
+                }
+                if (s->index[to] < s->low[v]) s->low[v] = s->index[to];
+            }
+            if (pushed) continue;
+
+            calls.pop_back();
+            if (!calls.empty()) {
+                const int parent = calls.back().first;
+                if (s->low[v] < s->low[parent]) s->low[parent] = s->low[v];
+            }
+            if (s->low[v] != s->index[v]) continue;
+
+            // <v> is the root of an SCC, which leaves the component
+            wcwc_component scc;
+            const int64_t scc_id = __atomic_fetch_add(&s->next_id, 1, __ATOMIC_RELAXED);
+            for (;;) {
+                const int n = st.back();
+                st.pop_back();
+                s->comp[n] = scc_id;
+                scc.push_back(n);
+                if (n == v) break;
+            }
+            wcwc_scc(s, scc, scc_id, pl, next);
+        }
+    }
+}
+
+VOID_TASK_4(wcwc_round, wcwc_search*, s, const wcwc_component*, comps, std::vector<wcwc_component>*, next, size_t, count)
+{
+    if (count == 1) {
+        wcwc_split(s, *comps, s->game->owner((*comps)[0]), *next);
+    } else {
+        SPAWN(wcwc_round, s, comps+count/2, next+count/2, count-count/2);
+        CALL(wcwc_round, s, comps, next, count/2);
+        SYNC(wcwc_round);
+    }
+}
+
+int
+Oink::solveTrivialCyclesParallel()
+{
+    const int n_nodes = game->vertexcount();
+
+    wcwc_search s;
+    s.game = game;
+    s.comp = new int64_t[n_nodes];
+    s.index = new int[n_nodes];
+    s.low = new int[n_nodes];
+    s.strategy = new int[n_nodes];
+    s.next_id = 2;
+    s.count = 0;
+
+    // the first components are the vertices of each player (numbered 0 and 1)
+    std::vector<wcwc_component> comps(2);
+    for (int v=0; v<n_nodes; v++) {
+        s.strategy[v] = -1;
+        if (disabled[v]) {
+            s.comp[v] = -1;
+        } else {
+            const int pl = game->owner(v);
+            s.comp[v] = pl;
+            comps[pl].push_back(v);
+        }
+    }
+    comps.erase(std::remove_if(comps.begin(), comps.end(), [] (const wcwc_component &c) { return c.empty(); }), comps.end());
+
+    while (!comps.empty()) {
+        std::vector<std::vector<wcwc_component>> next(comps.size());
+        RUN(wcwc_round, &s, comps.data(), next.data(), comps.size());
+        comps.clear();
+        for (auto &cs : next) {
+            for (auto &c : cs) comps.push_back(std::move(c));
+        }
+    }
+
+    // solve all winning cycles, then attract to them
+    for (int v=0; v<n_nodes; v++) {
+        if (s.strategy[v] != -1) solve(v, game->owner(v), s.strategy[v]);
+    }
+    flush();
+
+    delete[] s.comp;
+    delete[] s.index;
+    delete[] s.low;
+    delete[] s.strategy;
+    return s.count;
+}
+
+/**
+ * Solving the game per SCC.
+ *
+ * The SCCs of the unsolved vertices are computed once (Tarjan), and solved in reverse topological
+ * order: an SCC is ready when its edges to other SCCs all lead to solved vertices, which is tracked
+ * by counting these edges. Every round, each ready SCC that is not solved by attraction gets its own
+ * view and solver instance (chosen by its size, see Oink::solverFor), and the sequential solvers run
+ * at the same time on the Lace workers. The priorities
+ * of each view are compressed, so the solver only sees the priorities of the SCC. Ready SCCs share
+ * no vertices and have no edges between them, and the solvers only update their views. After the
+ * round, the solutions are copied to the game and flush attracts from them into the SCCs above.
+ */
+struct scc_job
+{
+    std::unique_ptr<SubgameView> view;
+    std::unique_ptr<Solver> solver;
+    const std::string *id;    // the solver (see Oink::solverFor)
+    bool concurrent;          // if the solver runs at the same time as other solvers
+    std::ostringstream log;   // the output of the solver, if concurrent
+    double time;              // the time the solver took
+};
+
+static void
+scc_run(scc_job *job)
+{
+    using namespace std::chrono;
+    auto before = steady_clock::now();
+    job->solver->run();
+    job->time = duration_cast<duration<double>>(steady_clock::now() - before).count();
+}
+
+VOID_TASK_2(scc_round, scc_job**, jobs, size_t, count)
+{
+    if (count == 1) {
+        scc_run(*jobs);
+    } else {
+        SPAWN(scc_round, jobs+count/2, count-count/2);
+        CALL(scc_round, jobs, count/2);
+        SYNC(scc_round);
+    }
+}
+
+struct scc_stats
+{
+    long count = 0;           // the number of SCCs solved by the solver
+    long nodes = 0;           // the number of nodes of these SCCs
+    double time = 0;          // the total time of the solver
+};
+
+void
+Oink::solveSCCs()
+{
+    const int n_nodes = game->vertexcount();
+    disabled = game->getSolved();
+
+    // find the SCCs; Tarjan finds every SCC after the SCCs it has edges to
+    int *scc = new int[n_nodes];   // the SCC of every unsolved vertex
+    int *index = new int[n_nodes];
+    int *low = new int[n_nodes];
+    for (int v=0; v<n_nodes; v++) scc[v] = -1;
+    for (int v=0; v<n_nodes; v++) index[v] = 0;
+
+    std::vector<int> members;      // the vertices of every SCC
+    std::vector<int> first;        // the index of the first vertex of every SCC in <members>
+    std::vector<int> st;
+    std::vector<std::pair<int, const int*>> calls;
+    int pre = 0;
+
+    for (int root=0; root<n_nodes; root++) {
+        if (disabled[root] or index[root] != 0) continue;
+        index[root] = low[root] = ++pre;
+        st.push_back(root);
+        calls.emplace_back(root, game->outs(root));
+
+        while (!calls.empty()) {
+            const int v = calls.back().first;
+            const int *&e = calls.back().second;
+            bool pushed = false;
+            for (int to = *e; to != -1; to = *++e) {
+                if (disabled[to] or scc[to] != -1) continue; // solved, or in an SCC that is found
+                if (index[to] == 0) {
+                    index[to] = low[to] = ++pre;
+                    st.push_back(to);
+                    calls.emplace_back(to, game->outs(to));
+                    pushed = true;
+                    break;
+                }
+                if (index[to] < low[v]) low[v] = index[to];
+            }
+            if (pushed) continue;
+
+            calls.pop_back();
+            if (!calls.empty()) {
+                const int parent = calls.back().first;
+                if (low[v] < low[parent]) low[parent] = low[v];
+            }
+            if (low[v] != index[v]) continue;
+
+            const int id = first.size();
+            first.push_back(members.size());
+            for (;;) {
+                const int w = st.back();
+                st.pop_back();
+                scc[w] = id;
+                members.push_back(w);
+                if (w == v) break;
+            }
+        }
+    }
+    first.push_back(members.size());
+    delete[] index;
+    delete[] low;
+
+    // count the edges from every SCC to other SCCs; the SCCs without them are ready
+    const int count = first.size() - 1;
+    std::vector<long> pending(count, 0);
+    for (int v : members) {
+        for (int to : game->succs(v)) {
+            if (!disabled[to] and scc[to] != scc[v]) pending[scc[v]]++;
+        }
+    }
+    std::vector<int> ready;
+    for (int c=0; c<count; c++) {
+        if (pending[c] == 0) ready.push_back(c);
+    }
+
+    logger << "found " << count << " SCCs." << std::endl;
+
+    const bool dispatch = smallSolver or largeSolver;
+    std::map<std::string, scc_stats> stats;
+    long left = members.size();
+
+    while (!ready.empty()) {
+        // make a view and a solver for every ready SCC that is not solved yet
+        std::vector<scc_job> jobs;
+        jobs.reserve(ready.size());
+        long size = 0;
+        for (int c : ready) {
+            std::vector<int> vertices;
+            for (int i=first[c]; i<first[c+1]; i++) {
+                if (!disabled[members[i]]) vertices.push_back(members[i]);
+            }
+            if (vertices.empty()) continue; // solved by attraction
+            std::sort(vertices.begin(), vertices.end());
+            size += vertices.size();
+
+            jobs.emplace_back();
+            scc_job &job = jobs.back();
+            job.id = &solverFor(vertices.size());
+            // parallel solvers run one at a time (they use the workers themselves)
+            job.concurrent = lace_workers() > 1 and !Solvers::isParallel(*job.id);
+            job.view.reset(makeView(std::move(vertices)));
+            const int d = job.view->compress();
+            if (trace) logger << "SCC of " << job.view->nodecount() << " nodes has " << d << " priorities" << std::endl;
+            view = job.view.get();
+            if (job.concurrent) solverLogger = &job.log;
+            job.solver = Solvers::construct(*job.id, *this, *game);
+            view = NULL;
+            solverLogger = NULL;
+            if (!job.solver->parseOptions(options)) {
+                logger << "error parsing options: " << options << std::endl;
+                exit(-1);
+            }
+        }
+
+        if (!jobs.empty()) {
+            if (jobs.size() == 1) logger << "solving bottom SCC of " << size << " nodes (";
+            else logger << "solving " << jobs.size() << " bottom SCCs of " << size << " nodes (";
+            logger << left << " nodes left)" << std::endl;
+
+            std::vector<scc_job*> concurrent;
+            for (auto &job : jobs) {
+                if (job.concurrent) concurrent.push_back(&job);
+                else scc_run(&job);
+            }
+            if (concurrent.size() > 1) RUN(scc_round, concurrent.data(), concurrent.size());
+            else if (concurrent.size() == 1) scc_run(concurrent[0]);
+
+            for (auto &job : jobs) {
+                if (job.concurrent) logger << job.log.str();
+                if (dispatch) {
+                    logger << "solved SCC of " << job.view->nodecount() << " nodes using " << *job.id << " in ";
+                    logger << std::fixed << std::setprecision(6) << job.time << " sec." << std::endl;
+                }
+                scc_stats &st = stats[*job.id];
+                st.count++;
+                st.nodes += job.view->nodecount();
+                st.time += job.time;
+                solveView(*job.view);
+            }
+            jobs.clear();
+
+            // attract into the SCCs above
+            flush();
+        }
+
+        // the ready SCCs are solved now, which may make the SCCs above ready
+        std::vector<int> next;
+        for (int c : ready) {
+            left -= first[c+1] - first[c];
+            for (int i=first[c]; i<first[c+1]; i++) {
+                for (int from : game->preds(members[i])) {
+                    const int d = scc[from];
+                    if (d != -1 and d != c and --pending[d] == 0) next.push_back(d);
+                }
+            }
+        }
+        ready.swap(next);
+    }
+
+    if (dispatch) {
+        for (auto &entry : stats) {
+            logger << entry.first << " solved " << entry.second.count << " SCCs of " << entry.second.nodes << " nodes in ";
+            logger << std::fixed << std::setprecision(6) << entry.second.time << " sec." << std::endl;
+        }
+    }
+
+    delete[] scc;
+}
+
 }
@@ -19,7 +19,10 @@
 
 namespace pg {
 
-Solver::Solver(Oink& oink, Game& game) : game(game), logger(oink.logger), trace(oink.trace), disabled(oink.disabled), oink(oink)
+Solver::Solver(Oink& oink, Game& game) : game(game), logger(oink.solverLogger != NULL ? *oink.solverLogger : oink.logger),
+    trace(oink.trace), sub(oink.view),
+    disabled(sub != NULL ? sub->disabled : oink.disabled), priorities(sub != NULL ? sub->priorities() : game.priorities()),
+    owners(sub != NULL ? sub->owners() : game.owner()), oink(oink)
 {
 #ifndef NDEBUG
     // sanity check if the game is properly sorted
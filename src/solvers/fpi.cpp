@@ -94,8 +94,7 @@ FPISolver::updateBlock(int i, int n)
         if (owner(i) == 0) {
             // see if player Even can go to a vertex currently good for Even
             onestep_winner = 1;
-            for (auto curedge = outs(i); *curedge != -1; curedge++) {
-                int to = *curedge;
+            for (int to : succs(i)) {
                 if (disabled[to]) continue;
                 const int winner_to = parity[to] ^ distraction[to];
                 if (winner_to == 0) {
@@ -109,8 +108,7 @@ FPISolver::updateBlock(int i, int n)
         } else {
             // see if player Odd can go to a vertex currently good for Odd
             onestep_winner = 0;
-            for (auto curedge = outs(i); *curedge != -1; curedge++) {
-                int to = *curedge;
+            for (int to : succs(i)) {
                 if (disabled[to]) continue;
                 const int winner_to = parity[to] ^ distraction[to];
                 if (winner_to == 1) {
@@ -25,6 +25,7 @@ namespace pg {
 // Yeah, globals.
 // But I don't want to copy the pointers in all Lace tasks.
 // And we're not using multiple PSISolver objects anyway.
+// (Solving per SCC runs one PSISolver at a time, because psi is added as a parallel solver.)
 
 static int k;         // k := 1+pr(G)
 static int *str;      // strategy (player/opponent)
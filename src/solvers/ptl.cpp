@@ -295,7 +295,7 @@ pearce_again:
 
         bool is_tangle = (tangle.size() > 1) or
             ((unsigned int)str[n] == n) or
-            (str[n] == -1 and game.has_edge(n, n));
+            (str[n] == -1 and has_selfloop(n));
         if (!is_tangle) {
             tangle.clear();
             continue;
@@ -759,7 +759,7 @@ PTLSolver::solve()
                     while (Q.nonempty()) {
                         const int v = Q.pop();
                         // TODO: should we need the check?
-                        if (!game.isSolved(v)) Solver::solve(v, 0, str[v]);
+                        if (!isSolved(v)) Solver::solve(v, 0, str[v]);
                         G[v] = false; // remove from Game
                         attractVertices(0, v, G, S0, G);
                         attractTangles(0, v, G, S0, G);
@@ -783,7 +783,7 @@ PTLSolver::solve()
             Q.swap(SolvedQ0);
             while (Q.nonempty()) {
                 const int v = Q.pop();
-                if (!game.isSolved(v)) Solver::solve(v, 0, str[v]);
+                if (!isSolved(v)) Solver::solve(v, 0, str[v]);
                 G[v] = false; // remove from Game
                 attractVertices(0, v, G, S0, G);
                 attractTangles(0, v, G, S0, G);
@@ -794,7 +794,7 @@ PTLSolver::solve()
             Q.swap(SolvedQ1);
             while (Q.nonempty()) {
                 const int v = Q.pop();
-                if (!game.isSolved(v)) Solver::solve(v, 1, str[v]);
+                if (!isSolved(v)) Solver::solve(v, 1, str[v]);
                 G[v] = false; // remove from Game
                 attractVertices(1, v, G, S1, G);
                 attractTangles(1, v, G, S1, G);
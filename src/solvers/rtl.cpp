@@ -294,7 +294,7 @@ pearce_again:
          */
 
         const bool is_not_tangle = (tangle.size() == 1) and
-            ((unsigned int)str[n] != n) and (str[n] != -1 or !game.has_edge(n, n));
+            ((unsigned int)str[n] != n) and (str[n] != -1 or !has_selfloop(n));
         if (is_not_tangle) {
             // std::cout << "not a tangle: " << pea_vidx[n] << std::endl;
             tangle.clear();
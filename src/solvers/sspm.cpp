@@ -584,12 +584,14 @@ SSPMSolver::run(int n_bits, int depth, int player)
      * Derive strategies.
      */
 
+    int *str = new int[nodecount()];
+    std::fill(str, str+nodecount(), -1);
+
     for (int v=0; v<nodecount(); v++) {
         if (disabled[v]) continue;
         if (pm_d[l*v] != -1) {
             if (owner(v) != player) {
-                // TODO: don't rely on the strategy array in the Game class
-                if (lift(v, -1, game.getStrategy()[v], player)) logger << "error: " << v << " is not progressive!" << std::endl;
+                if (lift(v, -1, str[v], player)) logger << "error: " << v << " is not progressive!" << std::endl;
             }
         }
     }
@@ -603,7 +605,7 @@ SSPMSolver::run(int n_bits, int depth, int player)
 
             if (pm_d[l*v] != -1) {
                 if (owner(v) != player) {
-                    logger << " => " << label_vertex(game.getStrategy(v));
+                    logger << " => " << label_vertex(str[v]);
                 }
             }
 
@@ -617,7 +619,7 @@ SSPMSolver::run(int n_bits, int depth, int player)
 
     for (int v=0; v<nodecount(); v++) {
         if (disabled[v]) continue;
-        if (pm_d[l*v] != -1) Solver::solve(v, 1-player, game.getStrategy(v));
+        if (pm_d[l*v] != -1) Solver::solve(v, 1-player, str[v]);
     }
 
     Solver::flush();
@@ -636,6 +638,7 @@ SSPMSolver::run(int n_bits, int depth, int player)
     }
     */
 
+    delete[] str;
     delete[] pm_d;
     delete[] tmp_d;
     delete[] best_d;
@@ -660,17 +663,17 @@ SSPMSolver::run()
     logger << "even wants " << ml << "-bounded adaptive " << h0 << "-counters." << std::endl;
     logger << "odd wants " << ml << "-bounded adaptive " << h1 << "-counters." << std::endl;
 
-    // if running bounded sspm, start with 1-bounded adaptive counters
-    int i = bounded ? 1 : ml;
+    // if running bounded sspm, start with 1-bounded adaptive counters (0-bounded for a single vertex)
+    int i = bounded ? std::min(1, ml) : ml;
 
     for (; i<=ml; i++) {
         int _l = lift_count, _a = lift_attempt;
-        uint64_t _c = game.count_unsolved(), c;
+        uint64_t _c = count_unsolved(), c;
 
         if (ODDFIRST) {
             // run odd counters
             run(i, h1, 1);
-            c = game.count_unsolved();
+            c = count_unsolved();
             logger << "after odd  with k=" << i << ", " << std::setw(9) << lift_count-_l << " lifts, " << std::setw(9) << lift_attempt-_a << " lift attempts, " << c << " unsolved left." << std::endl;
 
             // if now solved, no need to run odd counters
@@ -678,12 +681,12 @@ SSPMSolver::run()
 
             // run even counters
             run(i, h0, 0);
-            c = game.count_unsolved();
+            c = count_unsolved();
             logger << "after even with k=" << i << ", " << std::setw(9) << lift_count-_l << " lifts, " << std::setw(9) << lift_attempt-_a << " lift attempts, " << c << " unsolved left." << std::endl;
         } else {
             // run even counters
             run(i, h0, 0);
-            c = game.count_unsolved();
+            c = count_unsolved();
             logger << "after even with k=" << i << ", " << std::setw(9) << lift_count-_l << " lifts, " << std::setw(9) << lift_attempt-_a << " lift attempts, " << c << " unsolved left." << std::endl;
 
             // if now solved, no need to run odd counters
@@ -691,7 +694,7 @@ SSPMSolver::run()
 
             // run odd counters
             run(i, h1, 1);
-            c = game.count_unsolved();
+            c = count_unsolved();
             logger << "after odd  with k=" << i << ", " << std::setw(9) << lift_count-_l << " lifts, " << std::setw(9) << lift_attempt-_a << " lift attempts, " << c << " unsolved left." << std::endl;
         }
 
@@ -40,8 +40,7 @@ void
 TLSolver::attractVertices(const int pl, const int v, bitset &R, bitset &Z)
 {
     // attract vertices with an edge to <v>
-    for (auto curedge = ins(v); *curedge != -1; curedge++) {
-        int from = *curedge;
+    for (int from : preds(v)) {
         if (Z[from]) {
             // already in Z, maybe set strategy (for vertices in the original target set)
             if (owner(from) == pl and str[from] == -1) str[from] = v;
@@ -50,9 +49,7 @@ TLSolver::attractVertices(const int pl, const int v, bitset &R, bitset &Z)
                 // check if opponent can escape
                 unsigned int e = escs[from];
                 if (e == 0) {
-                    for (auto curedge = outs(from); *curedge != -1; curedge++) {
-                        if (G[*curedge]) e++;
-                    }
+                    for (int to : succs(from)) e += G[to];
                 }
                 escs[from] = --e;
                 if (e > 0) continue; // escapes
@@ -288,7 +285,7 @@ pearce_again:
          */
 
         const bool is_not_tangle = (tangle.size() == 1) and
-            ((unsigned int)str[n] != n) and (str[n] != -1 or !game.has_edge(n, n));
+            ((unsigned int)str[n] != n) and (str[n] != -1 or !has_selfloop(n));
         if (is_not_tangle) {
             // std::cout << "not a tangle: " << pea_vidx[n] << std::endl;
             tangle.clear();
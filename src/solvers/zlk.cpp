@@ -21,6 +21,7 @@
 #include <cassert>
 
 #include "zlk.hpp"
+#include "oink/memory.hpp"
 #include "lace.h"
 #include "printf.hpp"
 
@@ -31,7 +32,7 @@ static const int BOT = 0x80000001; // bottom state for vertex
 
 #define KC "\033[36;1m"
 
-ZLKSolver::ZLKSolver(Oink& oink, Game& game) : Solver(oink, game), Q(game.nodecount())
+ZLKSolver::ZLKSolver(Oink& oink, Game& game) : Solver(oink, game), Q(nodecount())
 {
 }
 
@@ -60,8 +61,7 @@ ZLKSolver::attractParT(WorkerP* __lace_worker, Task* __lace_dq_head, int pl, int
     par_helper* ours = pvec[LACE_WORKER_ID];
 
     // attract to <cur>
-    for (auto curedge = ins(cur); *curedge != -1; curedge++) {
-        int from = *curedge;
+    for (int from : preds(cur)) {
         int _r = region[from];
         if (_r == DIS or _r >= 0) continue; // not in subgame, or attracted
 
@@ -88,11 +88,10 @@ ZLKSolver::attractParT(WorkerP* __lace_worker, Task* __lace_dq_head, int pl, int
             if (_r == (BOT+1)) {
                 // we are the first, do add_and_fetch with the count
                 int count = 0;
-                for (auto curedge = outs(from); *curedge != -1; curedge++) {
-                    int to = *curedge;
-                    if (region[to] == DIS) continue; // do not count disabled
-                    if (region[to] >= 0 and region[to] < r) continue; // do not count supgame
-                    count--; // count to negative
+                for (int to : succs(from)) {
+                    // count to negative, but do not count disabled or supgame
+                    const int to_r = region[to];
+                    count -= to_r != DIS and (to_r < 0 or to_r >= r);
                 }
                 // now set count (in a CAS loop)
                 int new_r = count; // +1 -1 (count negative to -1)
@@ -233,8 +232,7 @@ ZLKSolver::attractExt(int i, int r, std::vector<int> *R)
             R->push_back(cur);
 
             // attract to <cur>
-            for (auto curedge = ins(cur); *curedge != -1; curedge++) {
-                int from = *curedge;
+            for (int from : preds(cur)) {
                 if (from >= i or region[from] == DIS or region[from] >= 0) continue; // cannot be attracted
 
                 if (owner(from) == pl) {
@@ -252,11 +250,9 @@ ZLKSolver::attractExt(int i, int r, std::vector<int> *R)
                     if (count == BOT) {
                         // compute count (to negative)
                         count = 1;
-                        auto curedge = outs(from);
-                        for (int to = *curedge; to != -1; to = *++curedge) {
-                            if (region[to] == DIS) continue;
-                            if (region[to] >= 0 and region[to] < r) continue;
-                            count--;
+                        for (int to : succs(from)) {
+                            const int to_r = region[to];
+                            count -= to_r != DIS and (to_r < 0 or to_r >= r);
                         }
                     } else {
                         count++;
@@ -309,8 +305,7 @@ ZLKSolver::attractLosing(const int i, const int r, std::vector<int> *S, std::vec
         if (owner(i) == pl) {
             // "loser" attraction
             bool can_escape = false;
-            auto curedge = outs(i);
-            for (int to = *curedge; to != -1; to = *++curedge) {
+            for (int to : succs(i)) {
                 if (region[to] < r) continue; // not in subgame, or -1/-2
                 if (winning[to] != pl) continue; // not an escape
                 can_escape = true;
@@ -326,8 +321,7 @@ ZLKSolver::attractLosing(const int i, const int r, std::vector<int> *S, std::vec
             }
         } else {
             // "winner" attraction
-            auto curedge = outs(i);
-            for (int to = *curedge; to != -1; to = *++curedge) {
+            for (int to : succs(i)) {
                 if (region[to] < r) continue; // not in subgame, or -1/-2
                 if (winning[to] == pl) continue; // not attracting
 #ifndef NDEBUG
@@ -354,8 +348,7 @@ ZLKSolver::attractLosing(const int i, const int r, std::vector<int> *S, std::vec
         winning[cur] = 1-pl;
 
         // attract to <cur>
-        auto curedge = ins(cur);
-        for (int from = *curedge; from != -1; from = *++curedge) {
+        for (int from : preds(cur)) {
             // if (region[from] == -1) LOGIC_ERROR;
             if (region[from] < r) continue; // not in subgame, or disabled
             if (winning[from] != pl) continue; // already lost
@@ -373,8 +366,7 @@ ZLKSolver::attractLosing(const int i, const int r, std::vector<int> *S, std::vec
             } else {
                 // owned by us
                 bool can_escape = false;
-                auto curedge = outs(from);
-                for (int to = *curedge; to != -1; to = *++curedge) {
+                for (int to : succs(from)) {
                     // if (region[to] == -1) LOGIC_ERROR;
                     if (region[to] < r) continue; // not in subgame, or disabled
                     if (winning[to] != pl) continue; // not an escape
@@ -403,9 +395,10 @@ ZLKSolver::run()
     iterations = 0;
 
     // allocate and initialize data structures
-    region = new int[nodecount()];
-    winning = new int[nodecount()];
-    strategy = new int[nodecount()];
+    region = (int*)alloc_array(sizeof(int[nodecount()]));
+    winning = (int*)alloc_array(sizeof(int[nodecount()]));
+    strategy = (int*)alloc_array(sizeof(int[nodecount()]));
+    if (region == (int*)0 or winning == (int*)0 or strategy == (int*)0) abort();
 
     std::vector<int> history;
     std::vector<int> W0, W1;
@@ -700,9 +693,9 @@ ZLKSolver::run()
         Solver::solve(i, winning[i], strategy[i]);
     }
 
-    delete[] region;
-    delete[] winning;
-    delete[] strategy;
+    free(region);
+    free(winning);
+    free(strategy);
 
     logger << "solved with " << iterations << " iterations." << std::endl;
 }
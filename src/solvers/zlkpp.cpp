@@ -240,6 +240,7 @@ void ZLKPPSolver::run() {
     std::fill(is_in_attractor, is_in_attractor + nodecount(), 0);
     
     strategy = new int[nodecount()];
+    std::fill(strategy, strategy + nodecount(), -1);
     
     // remove disabled nodes (they could be disabled by preprocessing)
     for (int v = 0; v < nodecount(); ++v)
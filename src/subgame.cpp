@@ -0,0 +1,170 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "oink/subgame.hpp"
+#include "oink/memory.hpp"
+#include "oink/error.hpp"
+
+namespace pg {
+
+template <typename T>
+static T*
+alloc(size_t count)
+{
+    T *res = (T*)alloc_array(sizeof(T[count]));
+    if (res == NULL) abort();
+    return res;
+}
+
+SubgameView::SubgameView(Game &game, std::vector<int> &&vertices, int *map) : vertices(std::move(vertices)), map(map)
+{
+    const int n = this->vertices.size();
+    assert(std::is_sorted(this->vertices.begin(), this->vertices.end()));
+    for (int v=0; v<n; v++) {
+        assert(map[this->vertices[v]] == -1);
+        map[this->vertices[v]] = v;
+    }
+
+    disabled.resize(n);
+    _selfloop.resize(n);
+    _owner.resize(n);
+    _priority = alloc<int>(n);
+    for (int v=0; v<n; v++) {
+        const int g = to_game(v);
+        _priority[v] = game.priority(g);
+        if (game.owner(g)) _owner[v] = true;
+    }
+
+    // the out-edges; the game successors of the members bound the size of the array
+    // (the map may contain vertices of other views, but there are no edges between views)
+    long bound = 1 + n;
+    for (int v=0; v<n; v++) bound += game.outcount(to_game(v));
+    _outedges = alloc<int>(bound);
+    _firstouts = alloc<edge_t>(n);
+    _outcount = alloc<int>(n);
+    edge_t len = 0;
+    _outedges[len++] = -1;
+    for (int v=0; v<n; v++) {
+        _firstouts[v] = len;
+        for (int to : game.succs(to_game(v))) {
+            const int w = map[to];
+            if (w != -1) {
+                assert(to_game(w) == to);
+                if (w == v) _selfloop[v] = true;
+                _outedges[len++] = w;
+            }
+        }
+        _outcount[v] = len - _firstouts[v];
+        _outedges[len++] = -1;
+    }
+    n_edges = len - 1 - n;
+
+    // the in-edges, in the same order as in the game
+    _inedges = alloc<int>(len);
+    _firstins = alloc<edge_t>(n);
+    _incount = alloc<int>(n);
+    len = 0;
+    _inedges[len++] = -1;
+    for (int v=0; v<n; v++) {
+        _firstins[v] = len;
+        for (int from : game.preds(to_game(v))) {
+            const int w = map[from];
+            if (w != -1) _inedges[len++] = w;
+        }
+        _incount[v] = len - _firstins[v];
+        _inedges[len++] = -1;
+    }
+    assert(len == 1 + n + n_edges);
+
+    // the solution
+    won.resize(n);
+    strategy = alloc<int>(n);
+    unsolved = alloc<int>(n);
+    for (int v=0; v<n; v++) unsolved[v] = _outcount[v];
+}
+
+SubgameView::~SubgameView()
+{
+    free(_priority);
+    free(_outedges);
+    free(_firstouts);
+    free(_outcount);
+    free(_inedges);
+    free(_firstins);
+    free(_incount);
+    free(strategy);
+    free(unsolved);
+    for (int g : vertices) map[g] = -1;
+}
+
+int
+SubgameView::compress()
+{
+    const int n = nodecount();
+    if (n == 0) return 0;
+    int d = 1;
+
+    // the vertices are in the same order as in the game, so ordered by priority
+    int prio = -1;
+    for (int v=0; v<n; v++) {
+        const int p_mod_v = priority(v)&1;
+        if (prio == -1) prio = p_mod_v;
+        else if (p_mod_v != prio%2) { prio += 1; d++; }
+        _priority[v] = prio;
+    }
+
+    return d;
+}
+
+void
+SubgameView::solve(int v, int winner, int strategy)
+{
+#ifndef NDEBUG
+    if (disabled[v]) LOGIC_ERROR;
+#endif
+
+    disabled[v] = true;
+    won[v] = winner;
+    this->strategy[v] = strategy;
+    todo.push_back(v);
+}
+
+void
+SubgameView::flush()
+{
+    // the same as Oink::flush, within the view
+    while (!todo.empty()) {
+        const int v = todo.back();
+        todo.pop_back();
+        const int winner = won[v];
+
+        for (int from : preds(v)) {
+            if (disabled[from]) continue;
+            if (owner(from) == winner) {
+                // node of winner
+                solve(from, winner, v);
+            } else {
+                // node of loser
+                if (--unsolved[from] == 0) solve(from, winner, -1);
+            }
+        }
+    }
+}
+
+}
@@ -16,7 +16,7 @@
 
 #include <iostream>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -31,26 +31,25 @@ main(int argc, char** argv)
 
     int n = 2*std::stoi(argv[1]);
 
-    Game game(3+3*n);
-    game.vec_init();
+    GameBuilder builder(3+3*n);
 
     /* create n+1 pieces */
     for (int i=0; i<=n; i++) {
-        game.init_vertex(3*i+0, n+1+i, (i&1));
-        game.init_vertex(3*i+1, i, (i&1));
-        game.init_vertex(3*i+2, i, 1-(i&1));
-        game.vec_add_edge(3*i+0, 3*i+1);
-        game.vec_add_edge(3*i+1, 3*i+2);
-        game.vec_add_edge(3*i+2, 3*i+1);
-        game.vec_add_edge(3*i+2, 3*i+2);
+        builder.init_vertex(3*i+0, n+1+i, (i&1));
+        builder.init_vertex(3*i+1, i, (i&1));
+        builder.init_vertex(3*i+2, i, 1-(i&1));
+        builder.add_edge(3*i+0, 3*i+1);
+        builder.add_edge(3*i+1, 3*i+2);
+        builder.add_edge(3*i+2, 3*i+1);
+        builder.add_edge(3*i+2, 3*i+2);
     }
     
     /* connect the pieces */
     for (int i=0; i<n; i++) {
-        game.vec_add_edge(3*i+2, 3*i+3);
-        game.vec_add_edge(3*i+4, 3*i+0);
+        builder.add_edge(3*i+2, 3*i+3);
+        builder.add_edge(3*i+4, 3*i+0);
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.write_pgsolver(std::cout);
 }
@@ -16,7 +16,7 @@
 
 #include <iostream>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -30,28 +30,27 @@ main(int argc, char** argv)
 
     int n = std::stoi(argv[1]);
 
-    Game game(4+n*4);
-    game.vec_init();
+    GameBuilder builder(4+n*4);
 
     /* create n+1 pieces */
     for (int i=0; i<=n; i++) {
-        game.init_vertex(4*i+0, i, 1-(i&1));
-        game.init_vertex(4*i+1, i, 1-(i&1));
-        game.init_vertex(4*i+2, i, (i&1));
-        game.init_vertex(4*i+3, i+3, (i&1));
-        game.vec_add_edge(4*i+0, 4*i+1);
-        game.vec_add_edge(4*i+1, 4*i+0);
-        game.vec_add_edge(4*i+1, 4*i+2);
-        game.vec_add_edge(4*i+2, 4*i+1);
-        game.vec_add_edge(4*i+3, 4*i+2);
+        builder.init_vertex(4*i+0, i, 1-(i&1));
+        builder.init_vertex(4*i+1, i, 1-(i&1));
+        builder.init_vertex(4*i+2, i, (i&1));
+        builder.init_vertex(4*i+3, i+3, (i&1));
+        builder.add_edge(4*i+0, 4*i+1);
+        builder.add_edge(4*i+1, 4*i+0);
+        builder.add_edge(4*i+1, 4*i+2);
+        builder.add_edge(4*i+2, 4*i+1);
+        builder.add_edge(4*i+3, 4*i+2);
     }
     
     /* connect the pieces */
     for (int i=0; i<n; i++) {
-        game.vec_add_edge(4*i+6, 4*i+3);
-        game.vec_add_edge(4*i+1, 4*i+7);
+        builder.add_edge(4*i+6, 4*i+3);
+        builder.add_edge(4*i+1, 4*i+7);
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.write_pgsolver(std::cout);
 }
@@ -16,7 +16,7 @@
 
 #include <iostream>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -30,31 +30,30 @@ main(int argc, char** argv)
 
     const int n = std::stoi(argv[1]);
 
-    Game game(1 + 5*n);
-    game.vec_init();
+    GameBuilder builder(1 + 5*n);
 
-    game.init_vertex(0, 0, 1);              // root of the distracted tangle
-    game.vec_add_edge(0, 0);                // self-loop
+    builder.init_vertex(0, 0, 1);              // root of the distracted tangle
+    builder.add_edge(0, 0);                    // self-loop
 
     for (int i=0; i<n; i++) {
         int c = 5*i+1;
         int d = 2*(n+i+1);
-        game.init_vertex(c+0, 2*(n-i), 0);  // distracted vertex
-        game.init_vertex(c+1, d, 0);        // distraction
-        game.init_vertex(c+2, 1, 1);        // opponent tangle start
-        game.init_vertex(c+3, 1, 0);        // opponent tangle end
-        game.init_vertex(c+4, d+1, 0);      // attracting odd vertex
-        game.vec_add_edge(c+0, 0);          // from distracted vertex to root
-        game.vec_add_edge(0, c+0);          // from root to distracted vertex
-        game.vec_add_edge(c+0, c+1);        // from distracted vertex to distraction
-        game.vec_add_edge(c+1, c+2);        // from distraction to tangle
-        game.vec_add_edge(c+2, c+3);        // tangle forward edge
-        game.vec_add_edge(c+3, c+2);        // tangle backward edge
-        game.vec_add_edge(c+3, c+4);        // tangle to attracting odd vertex
-        game.vec_add_edge(c+4, c);          // attracting odd vertex to distracted tangle
+        builder.init_vertex(c+0, 2*(n-i), 0);  // distracted vertex
+        builder.init_vertex(c+1, d, 0);        // distraction
+        builder.init_vertex(c+2, 1, 1);        // opponent tangle start
+        builder.init_vertex(c+3, 1, 0);        // opponent tangle end
+        builder.init_vertex(c+4, d+1, 0);      // attracting odd vertex
+        builder.add_edge(c+0, 0);              // from distracted vertex to root
+        builder.add_edge(0, c+0);              // from root to distracted vertex
+        builder.add_edge(c+0, c+1);            // from distracted vertex to distraction
+        builder.add_edge(c+1, c+2);            // from distraction to tangle
+        builder.add_edge(c+2, c+3);            // tangle forward edge
+        builder.add_edge(c+3, c+2);            // tangle backward edge
+        builder.add_edge(c+3, c+4);            // tangle to attracting odd vertex
+        builder.add_edge(c+4, c);              // attracting odd vertex to distracted tangle
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.sort();
     game.renumber();
     game.write_pgsolver(std::cout);
@@ -16,7 +16,7 @@
 
 #include <iostream>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -35,24 +35,23 @@ main(int argc, char** argv)
     // extension: 3*(n*n+(n&1))/4 + n
     int n_positions = 3*(n+1) + n + (3*n*n+(n&1))/4;
 
-    Game game(n_positions);
-    game.vec_init();
+    GameBuilder builder(n_positions);
 
     /* create n+1 pieces */
     for (int i=0; i<=n; i++) {
-        game.init_vertex(3*i+0, n+1+i, (i&1));
-        game.init_vertex(3*i+1, i, (i&1));
-        game.init_vertex(3*i+2, i, 1-(i&1));
-        game.vec_add_edge(3*i+0, 3*i+1);
-        game.vec_add_edge(3*i+1, 3*i+2);
-        game.vec_add_edge(3*i+2, 3*i+1);
-        game.vec_add_edge(3*i+2, 3*i+2);
+        builder.init_vertex(3*i+0, n+1+i, (i&1));
+        builder.init_vertex(3*i+1, i, (i&1));
+        builder.init_vertex(3*i+2, i, 1-(i&1));
+        builder.add_edge(3*i+0, 3*i+1);
+        builder.add_edge(3*i+1, 3*i+2);
+        builder.add_edge(3*i+2, 3*i+1);
+        builder.add_edge(3*i+2, 3*i+2);
     }
     
     /* connect the pieces */
     for (int i=0; i<n; i++) {
-        game.vec_add_edge(3*i+2, 3*i+3);
-        game.vec_add_edge(3*i+4, 3*i+0);
+        builder.add_edge(3*i+2, 3*i+3);
+        builder.add_edge(3*i+4, 3*i+0);
     }
 
     /* create more connectors */
@@ -65,27 +64,27 @@ main(int argc, char** argv)
             int cj = 3*j+2;
             if (i_parity == j_parity) {
                 // same parity, only need 1 
-                game.init_vertex(nxt, 0, 1-i_parity);
-                game.vec_add_edge(ci, nxt);
-                game.vec_add_edge(cj, nxt);
-                game.vec_add_edge(nxt, ci);
-                game.vec_add_edge(nxt, cj);
+                builder.init_vertex(nxt, 0, 1-i_parity);
+                builder.add_edge(ci, nxt);
+                builder.add_edge(cj, nxt);
+                builder.add_edge(nxt, ci);
+                builder.add_edge(nxt, cj);
                 nxt++;
             } else {
                 // different parity, so we need two
-                game.init_vertex(nxt,   0, 1-i_parity);
-                game.init_vertex(nxt+1, 0, 1-j_parity);
-                game.vec_add_edge(ci, nxt);
-                game.vec_add_edge(nxt, ci);
-                game.vec_add_edge(nxt, nxt+1);
-                game.vec_add_edge(nxt+1, nxt);
-                game.vec_add_edge(cj, nxt+1);
-                game.vec_add_edge(nxt+1, cj);
+                builder.init_vertex(nxt,   0, 1-i_parity);
+                builder.init_vertex(nxt+1, 0, 1-j_parity);
+                builder.add_edge(ci, nxt);
+                builder.add_edge(nxt, ci);
+                builder.add_edge(nxt, nxt+1);
+                builder.add_edge(nxt+1, nxt);
+                builder.add_edge(cj, nxt+1);
+                builder.add_edge(nxt+1, cj);
                 nxt+=2;
             }
         }        
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.write_pgsolver(std::cout);
 }
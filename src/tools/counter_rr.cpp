@@ -16,7 +16,7 @@
 
 #include <iostream>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -30,32 +30,31 @@ main(int argc, char** argv)
 
     int n = std::stoi(argv[1]);
 
-    Game game(4*n);
-    game.vec_init();
+    GameBuilder builder(4*n);
 
     // generate the Nth game
     for (int i=0; i<n; i++) {
-        game.init_vertex(4*i,   n-1-i, (n+i)&1);
-        game.init_vertex(4*i+1, n-1-i, (n+i)&1);
-        game.init_vertex(4*i+2, n+1+i, (n+i)&1);
-        game.init_vertex(4*i+3, n+1+i, (n+i)&1);
+        builder.init_vertex(4*i,   n-1-i, (n+i)&1);
+        builder.init_vertex(4*i+1, n-1-i, (n+i)&1);
+        builder.init_vertex(4*i+2, n+1+i, (n+i)&1);
+        builder.init_vertex(4*i+3, n+1+i, (n+i)&1);
         // add edges within the group
-        game.vec_add_edge(4*i,   4*i+1);
-        game.vec_add_edge(4*i+1, 4*i);
-        game.vec_add_edge(4*i+2, 4*i+3);
-        game.vec_add_edge(4*i+3, 4*i+2);
-        game.vec_add_edge(4*i,   4*i+2);
-        game.vec_add_edge(4*i+1, 4*i+3);
+        builder.add_edge(4*i,   4*i+1);
+        builder.add_edge(4*i+1, 4*i);
+        builder.add_edge(4*i+2, 4*i+3);
+        builder.add_edge(4*i+3, 4*i+2);
+        builder.add_edge(4*i,   4*i+2);
+        builder.add_edge(4*i+1, 4*i+3);
         // add edges to the next group
         if (i == (n-1)) {
-            game.vec_add_edge(4*i+2, 0);
-            game.vec_add_edge(4*i+3, 1);
+            builder.add_edge(4*i+2, 0);
+            builder.add_edge(4*i+3, 1);
         } else {
-            game.vec_add_edge(4*i+2, 4*i+4);
-            game.vec_add_edge(4*i+3, 4*i+5);
+            builder.add_edge(4*i+2, 4*i+4);
+            builder.add_edge(4*i+3, 4*i+5);
         }
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.write_pgsolver(std::cout);
 }
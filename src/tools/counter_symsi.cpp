@@ -17,7 +17,7 @@
 #include <iostream>
 #include <memory>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace pg;
 
@@ -42,8 +42,7 @@ main(int argc, char** argv)
     int n = std::stoi(argv[1]);
     int N = 16*n+16;
 
-    Game game(2+n*10);
-    game.vec_init();
+    GameBuilder builder(2+n*10);
 
     /* create n pieces */
     for (int i=0; i<n; i++) {
@@ -57,20 +56,20 @@ main(int argc, char** argv)
         int k = 10*i+7;
         int h = 10*i+8;
         int l = 10*i+9;
-        /* a */ game.init_vertex(a, N+2*i-1, 0, string_format("a_%d", i+1));    
-        /* d */ game.init_vertex(d, N+2*i,   1, string_format("d_%d", i+1));
-        /* c */ game.init_vertex(c, 14*i+1,  0, string_format("c_%d", i+1));
-        /* e */ game.init_vertex(e, 14*i+4,  1, string_format("e_%d", i+1));
-        /* m */ game.init_vertex(m, 14*i+3,  0, string_format("m_%d", i+1));
-        /* f */ game.init_vertex(f, 14*i+6,  1, string_format("f_%d", i+1));
-        /* g */ game.init_vertex(g, 14*i+8,  1, string_format("g_%d", i+1));
-        /* k */ game.init_vertex(k, 14*i+11, 0, string_format("k_%d", i+1));
-        /* h */ game.init_vertex(h, 14*i+10, 1, string_format("h_%d", i+1));
-        /* l */ game.init_vertex(l, 14*i+13, 0, string_format("l_%d", i+1));
+        /* a */ builder.init_vertex(a, N+2*i-1, 0, string_format("a_%d", i+1));    
+        /* d */ builder.init_vertex(d, N+2*i,   1, string_format("d_%d", i+1));
+        /* c */ builder.init_vertex(c, 14*i+1,  0, string_format("c_%d", i+1));
+        /* e */ builder.init_vertex(e, 14*i+4,  1, string_format("e_%d", i+1));
+        /* m */ builder.init_vertex(m, 14*i+3,  0, string_format("m_%d", i+1));
+        /* f */ builder.init_vertex(f, 14*i+6,  1, string_format("f_%d", i+1));
+        /* g */ builder.init_vertex(g, 14*i+8,  1, string_format("g_%d", i+1));
+        /* k */ builder.init_vertex(k, 14*i+11, 0, string_format("k_%d", i+1));
+        /* h */ builder.init_vertex(h, 14*i+10, 1, string_format("h_%d", i+1));
+        /* l */ builder.init_vertex(l, 14*i+13, 0, string_format("l_%d", i+1));
     }
 
-    game.init_vertex(10*n,   1,       0, string_format("a_%d", n+1));
-    game.init_vertex(10*n+1, 2, 1, string_format("d_%d", n+1));
+    builder.init_vertex(10*n,   1,       0, string_format("a_%d", n+1));
+    builder.init_vertex(10*n+1, 2, 1, string_format("d_%d", n+1));
 
     /* connect the pieces */
     for (int i=0; i<n; i++) {
@@ -85,35 +84,35 @@ main(int argc, char** argv)
         int h = 10*i+8;
         int l = 10*i+9;
 
-        game.vec_add_edge(a, c);
-        game.vec_add_edge(d, h);
-        game.vec_add_edge(c, e);
-        game.vec_add_edge(c, m);
-        game.vec_add_edge(c, 0);
-        game.vec_add_edge(m, c);
-        game.vec_add_edge(m, f);
-        game.vec_add_edge(m, 0);
-        game.vec_add_edge(g, h);
-        game.vec_add_edge(g, k);
-        game.vec_add_edge(g, 1);
-        game.vec_add_edge(h, l);
-        game.vec_add_edge(h, g);
-        game.vec_add_edge(h, 1);
-        game.vec_add_edge(e, a+10);
-        game.vec_add_edge(e, m);
-        game.vec_add_edge(f, d+10);
-        game.vec_add_edge(f, c);
-        game.vec_add_edge(k, a+10);
-        game.vec_add_edge(k, h);
-        game.vec_add_edge(l, d+10);
-        game.vec_add_edge(l, g);
+        builder.add_edge(a, c);
+        builder.add_edge(d, h);
+        builder.add_edge(c, e);
+        builder.add_edge(c, m);
+        builder.add_edge(c, 0);
+        builder.add_edge(m, c);
+        builder.add_edge(m, f);
+        builder.add_edge(m, 0);
+        builder.add_edge(g, h);
+        builder.add_edge(g, k);
+        builder.add_edge(g, 1);
+        builder.add_edge(h, l);
+        builder.add_edge(h, g);
+        builder.add_edge(h, 1);
+        builder.add_edge(e, a+10);
+        builder.add_edge(e, m);
+        builder.add_edge(f, d+10);
+        builder.add_edge(f, c);
+        builder.add_edge(k, a+10);
+        builder.add_edge(k, h);
+        builder.add_edge(l, d+10);
+        builder.add_edge(l, g);
     }
 
-    game.vec_add_edge(10*n,   10*n);
-    game.vec_add_edge(10*n+1, 10*n+1);
-    game.vec_add_edge(10*n, 0);
-    game.vec_add_edge(10*n+1,1);
+    builder.add_edge(10*n,   10*n);
+    builder.add_edge(10*n+1, 10*n+1);
+    builder.add_edge(10*n, 0);
+    builder.add_edge(10*n+1,1);
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.write_pgsolver(std::cout);
 }
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+#include <bzlib.h>
+#include <zlib.h>
+
+#include "oink/mappedfile.hpp"
+#include "tools/decompress.hpp"
+#include "lace.h"
+
+namespace pg {
+
+typedef unsigned char byte;
+
+void
+decompressed_text::reserve(size_t count)
+{
+    if (count <= capacity) return;
+    // (realloc moves large buffers by remapping their pages, without copying)
+    char *grown = (char*)realloc(data, count);
+    if (grown == NULL) abort();
+    data = grown;
+    capacity = count;
+}
+
+void
+decompressed_text::shrink(void)
+{
+    if (size == capacity or size == 0) return;
+    char *shrunk = (char*)realloc(data, size);
+    if (shrunk == NULL) return;
+    data = shrunk;
+    capacity = size;
+}
+
+/**
+ * A part of the compressed file that can be decompressed independently.
+ * For gzip members, the size of the output is known in advance and the output is written
+ * directly to its place in the result; for bzip2 streams, the output is written to <buf>.
+ */
+struct compressed_part
+{
+    const byte *in;
+    size_t in_size;
+    char *out;                  // (gzip) where to write the output
+    size_t out_size;            // (gzip) the size of the output
+    decompressed_text buf;      // (bzip2) the output
+    bool failed;
+};
+
+/**
+ * Make room for more output in <out>: double the capacity, starting at 64 KB.
+ */
+static inline void
+grow(decompressed_text &out)
+{
+    if (out.size == out.capacity) out.reserve(std::max(out.capacity*2, (size_t)1<<16));
+}
+
+/**
+ * Inflate the gzip data <in> of <size> bytes, appending to <out>, growing <out> as needed.
+ * Handles multiple members. Returns true if successful.
+ */
+static bool
+gunzip(const byte *in, size_t size, decompressed_text &out)
+{
+    const byte *in_end = in + size;
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 16+MAX_WBITS) != Z_OK) return false;
+
+    bool result = false;
+    for (;;) {
+        grow(out);
+        const size_t in_avail = std::min((size_t)(in_end-in), (size_t)UINT_MAX);
+        const size_t out_avail = std::min(out.capacity-out.size, (size_t)UINT_MAX);
+        zs.next_in = (Bytef*)in;
+        zs.avail_in = in_avail;
+        zs.next_out = (Bytef*)out.data + out.size;
+        zs.avail_out = out_avail;
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        in += in_avail - zs.avail_in;
+        out.size += out_avail - zs.avail_out;
+        if (ret == Z_STREAM_END) {
+            // continue with the next member, if any (ignore trailing garbage like gzip does)
+            if (in_end-in >= 2 and in[0] == 0x1f and in[1] == 0x8b) {
+                inflateReset(&zs);
+                continue;
+            }
+            result = true;
+            break;
+        } else if (ret == Z_BUF_ERROR) {
+            if (in == in_end) break; // truncated
+        } else if (ret != Z_OK) {
+            break;
+        }
+    }
+
+    inflateEnd(&zs);
+    return result;
+}
+
+/**
+ * Decompress the bzip2 data <in> of <size> bytes, appending to <out>, growing <out> as needed.
+ * Handles multiple streams. Returns true if successful.
+ */
+static bool
+bunzip2(const byte *in, size_t size, decompressed_text &out)
+{
+    const byte *in_end = in + size;
+
+    bz_stream bz;
+    memset(&bz, 0, sizeof(bz));
+    if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK) return false;
+
+    bool result = false;
+    for (;;) {
+        grow(out);
+        const size_t in_avail = std::min((size_t)(in_end-in), (size_t)UINT_MAX);
+        const size_t out_avail = std::min(out.capacity-out.size, (size_t)UINT_MAX);
+        bz.next_in = (char*)in;
+        bz.avail_in = in_avail;
+        bz.next_out = out.data + out.size;
+        bz.avail_out = out_avail;
+        int ret = BZ2_bzDecompress(&bz);
+        in += in_avail - bz.avail_in;
+        out.size += out_avail - bz.avail_out;
+        if (ret == BZ_STREAM_END) {
+            // continue with the next stream, if any
+            if (in_end-in >= 4 and memcmp(in, "BZh", 3) == 0) {
+                BZ2_bzDecompressEnd(&bz);
+                memset(&bz, 0, sizeof(bz));
+                if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK) return false;
+                continue;
+            }
+            result = true;
+            break;
+        } else if (ret != BZ_OK) {
+            break;
+        } else if (in == in_end and bz.avail_out != 0) {
+            break; // truncated
+        }
+    }
+
+    BZ2_bzDecompressEnd(&bz);
+    return result;
+}
+
+static void
+decompress_part(compressed_part *p, bool gzip)
+{
+    if (gzip) {
+        // a single member with a known output size, inflate directly into the result
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, 16+MAX_WBITS) != Z_OK) {
+            p->failed = true;
+            return;
+        }
+        zs.next_in = (Bytef*)p->in;
+        zs.avail_in = p->in_size;
+        zs.next_out = (Bytef*)p->out;
+        zs.avail_out = p->out_size;
+        p->failed = inflate(&zs, Z_FINISH) != Z_STREAM_END or zs.avail_out != 0 or zs.avail_in != 0;
+        inflateEnd(&zs);
+    } else {
+        p->buf.reserve(p->in_size * 4);
+        p->failed = !bunzip2(p->in, p->in_size, p->buf);
+        p->buf.shrink();
+    }
+}
+
+VOID_TASK_3(decompress_parts, compressed_part*, parts, size_t, count, bool, gzip)
+{
+    if (count == 1) {
+        decompress_part(parts, gzip);
+    } else {
+        SPAWN(decompress_parts, parts+count/2, count-count/2, gzip);
+        CALL(decompress_parts, parts, count/2, gzip);
+        SYNC(decompress_parts);
+    }
+}
+
+/**
+ * Find the BGZF members of the gzip data. Every member has an extra field "BC" with
+ * the size of the member, and the last 4 bytes of the member give the size of the output.
+ * Returns false if some member is not a BGZF member.
+ */
+static bool
+find_bgzf_members(const byte *data, size_t size, std::vector<compressed_part> &parts)
+{
+    size_t pos = 0;
+    while (pos != size) {
+        const byte *p = data + pos;
+        if (size - pos < 18) return false;
+        if (p[0] != 0x1f or p[1] != 0x8b or p[2] != 8 or (p[3] & 4) == 0) return false;
+        const size_t xlen = p[10] | (p[11] << 8);
+        if (size - pos < 12 + xlen) return false;
+
+        // find the "BC" subfield
+        size_t bsize = 0;
+        for (size_t x = 12; x + 4 <= 12 + xlen;) {
+            const size_t slen = p[x+2] | (p[x+3] << 8);
+            if (p[x] == 'B' and p[x+1] == 'C' and slen == 2 and x + 6 <= 12 + xlen) {
+                bsize = (p[x+4] | (p[x+5] << 8)) + 1;
+                break;
+            }
+            x += 4 + slen;
+        }
+        if (bsize < 12 + xlen + 8 or bsize > size - pos) return false;
+
+        const byte *t = p + bsize - 4;
+        compressed_part c;
+        c.in = p;
+        c.in_size = bsize;
+        c.out = NULL;
+        c.out_size = (size_t)t[0] | ((size_t)t[1] << 8) | ((size_t)t[2] << 16) | ((size_t)t[3] << 24);
+        c.failed = false;
+        parts.push_back(std::move(c));
+        pos += bsize;
+    }
+    return true;
+}
+
+/**
+ * Split the bzip2 data at the start of every stream ("BZh" <level> and the block or end-of-stream magic).
+ * Streams end byte-aligned, but a match may also be a coincidence inside the compressed data;
+ * then decompressing that part fails and we decompress sequentially instead.
+ */
+static void
+find_bzip2_streams(const byte *data, size_t size, std::vector<compressed_part> &parts)
+{
+    static const byte block_magic[6] = { 0x31, 0x41, 0x59, 0x26, 0x53, 0x59 };
+    static const byte eos_magic[6] = { 0x17, 0x72, 0x45, 0x38, 0x50, 0x90 };
+
+    size_t start = 0;
+    const byte *p = data + 1;
+    const byte *end = data + size;
+    while (end - p >= 10) {
+        p = (const byte*)memchr(p, 'B', end - p - 9);
+        if (p == NULL) break;
+        if (p[1] == 'Z' and p[2] == 'h' and p[3] >= '1' and p[3] <= '9' and
+            (memcmp(p+4, block_magic, 6) == 0 or memcmp(p+4, eos_magic, 6) == 0)) {
+            compressed_part c;
+            c.in = data + start;
+            c.in_size = (p - data) - start;
+            c.out = NULL;
+            c.out_size = 0;
+            c.failed = false;
+            parts.push_back(std::move(c));
+            start = p - data;
+        }
+        p++;
+    }
+    compressed_part c;
+    c.in = data + start;
+    c.in_size = size - start;
+    c.out = NULL;
+    c.out_size = 0;
+    c.failed = false;
+    parts.push_back(std::move(c));
+}
+
+decompressed_text
+decompress_file(const std::string &filename)
+{
+    MappedFile file(filename);
+    file.sequential();
+
+    const byte *data = (const byte*)file.data();
+    const size_t size = file.size();
+
+    const bool gzip = size >= 2 and data[0] == 0x1f and data[1] == 0x8b;
+    const bool bzip2 = size >= 4 and memcmp(data, "BZh", 3) == 0;
+    if (!gzip and !bzip2) throw std::runtime_error("unknown compression format");
+
+    decompressed_text res;
+
+    if (lace_workers() != 0) {
+        std::vector<compressed_part> parts;
+        if (gzip) {
+            if (find_bgzf_members(data, size, parts) and parts.size() > 1) {
+                // every member has a known output size, so the result can be assembled in place
+                size_t total = 0;
+                for (auto &c : parts) total += c.out_size;
+                res.reserve(total);
+                for (auto &c : parts) {
+                    c.out = res.data + res.size;
+                    res.size += c.out_size;
+                }
+                RUN(decompress_parts, parts.data(), parts.size(), true);
+                if (std::none_of(parts.begin(), parts.end(), [] (const compressed_part &c) { return c.failed; })) return res;
+            }
+        } else {
+            find_bzip2_streams(data, size, parts);
+            if (parts.size() > 1) {
+                RUN(decompress_parts, parts.data(), parts.size(), false);
+                if (std::none_of(parts.begin(), parts.end(), [] (const compressed_part &c) { return c.failed; })) {
+                    // append the parts to the first part, releasing every part after it is copied,
+                    // so at most one part is held twice
+                    res = std::move(parts[0].buf);
+                    for (size_t i=1; i<parts.size(); i++) {
+                        decompressed_text part = std::move(parts[i].buf);
+                        res.reserve(res.size + part.size);
+                        if (part.size != 0) memcpy(res.data + res.size, part.data, part.size);
+                        res.size += part.size;
+                    }
+                    return res;
+                }
+            }
+        }
+        // fall back to sequential decompression
+        parts.clear();
+        res = decompressed_text();
+    }
+
+    if (gzip) {
+        // the last 4 bytes give the size (modulo 2^32) of the last member, which is a good first guess
+        size_t hint = size >= 4 ? (size_t)data[size-4] | ((size_t)data[size-3] << 8) | ((size_t)data[size-2] << 16) | ((size_t)data[size-1] << 24) : 0;
+        res.reserve(std::max(hint+1, size*2));
+        if (!gunzip(data, size, res)) throw std::runtime_error("invalid gzip data");
+    } else {
+        res.reserve(size*4);
+        if (!bunzip2(data, size, res)) throw std::runtime_error("invalid bzip2 data");
+    }
+    res.shrink();
+    return res;
+}
+
+/**
+ * Get the memory that is available to this process, from MemAvailable in /proc/meminfo
+ * (or the free physical memory if that is not available).
+ */
+static size_t
+available_memory(void)
+{
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        unsigned long long kb;
+        if (sscanf(line.c_str(), "MemAvailable: %llu kB", &kb) == 1) return (size_t)kb * 1024;
+    }
+    const long pages = sysconf(_SC_AVPHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 or page_size <= 0) return SIZE_MAX;
+    return (size_t)pages * (size_t)page_size;
+}
+
+bool
+decompress_fits(const std::string &filename)
+{
+    MappedFile file(filename);
+    const byte *data = (const byte*)file.data();
+    const size_t size = file.size();
+
+    // the size of the text: exact for BGZF files, otherwise an upper estimate
+    size_t text = size * 10;
+    std::vector<compressed_part> parts;
+    if (size >= 2 and data[0] == 0x1f and data[1] == 0x8b and find_bgzf_members(data, size, parts)) {
+        text = 0;
+        for (auto &c : parts) text += c.out_size;
+    }
+
+    // the arrays of the parsed game take about as much memory as the text
+    return 2 * text <= available_memory();
+}
+
+}
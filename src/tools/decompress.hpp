@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 Tom van Dijk
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DECOMPRESS_HPP
+#define DECOMPRESS_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace pg {
+
+/**
+ * The output of decompress_file. The text is allocated with malloc and grows with realloc, which moves
+ * large buffers without copying them, so decompressing never holds two copies of the output.
+ */
+struct decompressed_text
+{
+    char *data = NULL;      // the text (not terminated)
+    size_t size = 0;        // the size of the text
+    size_t capacity = 0;    // the allocated size of <data>
+
+    decompressed_text() {}
+    decompressed_text(const decompressed_text&) = delete;
+    decompressed_text(decompressed_text &&other) noexcept { *this = std::move(other); }
+    ~decompressed_text() { free(data); }
+
+    decompressed_text& operator=(decompressed_text &&other) noexcept
+    {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(capacity, other.capacity);
+        return *this;
+    }
+
+    void reserve(size_t count); // ensure that the capacity is at least <count> (aborts if out of memory)
+    void shrink(void);          // release the memory after <size>
+};
+
+/**
+ * Decompress the gzip or bzip2 file <filename> into memory, so it can be given to
+ * PGParser::parse_pgsolver_buffer. The format is detected from the contents of the file.
+ *
+ * Files that consist of independent parts are decompressed in parallel if Lace is running:
+ * - gzip files with BGZF members (bgzip), which record the compressed size of each member
+ * - bzip2 files with multiple streams (pbzip2, or concatenated bzip2 files)
+ * Other files are decompressed sequentially, directly into the result.
+ *
+ * Throws std::runtime_error if the file cannot be read or is not valid.
+ */
+decompressed_text decompress_file(const std::string &filename);
+
+/**
+ * Check whether decompressing <filename> into memory (with decompress_file) leaves enough memory to
+ * parse the game. Uses the size of the output if the file records it (BGZF), and otherwise assumes
+ * that text games compress at most 10 times. If not, read the file as a stream instead, which does
+ * not hold the text in memory.
+ */
+bool decompress_fits(const std::string &filename);
+
+}
+
+#endif
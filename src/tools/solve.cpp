@@ -18,6 +18,7 @@
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <sys/stat.h>
 #include <sys/time.h>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -30,8 +31,11 @@
 #include "oink/oink.hpp"
 #include "oink/solvers.hpp"
 #include "oink/pgparser.hpp"
+#include "oink/memory.hpp"
 #include "verifier.hpp"
+#include "tools/decompress.hpp"
 #include "tools/getrss.h"
+#include "lace.h"
 
 using namespace pg;
 
@@ -201,20 +205,30 @@ int main(int argc, char **argv)
         ("sol", "Input (partial) solution", cxxopts::value<std::string>())
         ("o,output", "Output game or solution", cxxopts::value<std::string>())
         ("dot", "Write .dot file (before preprocessing)", cxxopts::value<std::string>())
+        ("pgb", "Write binary .pgb file (before preprocessing)", cxxopts::value<std::string>())
+        ("pgc", "Write compact .pgc file (before preprocessing)", cxxopts::value<std::string>())
         /* Preprocessing */
         ("inflate", "Inflate game")
         ("compress", "Compress game")
         ("no-single", "Do not solve single-parity games during preprocessing")
         ("no-loops", "Do not remove self-loops during preprocessing (default behavior)")
         ("no-wcwc", "Do not solve winner-controlled winning cycles during preprocessing")
+        ("par-wcwc", "Solve winner-controlled winning cycles in parallel (with -w)")
         ("no", "Do not touch the game at all")
         /* Solving */
-        ("scc", "Iteratively solve bottom SCCs")
+        ("scc", "Solve per SCC, starting from the bottom SCCs")
+        ("no-views", "Do not give the solvers a compact view of small subgames")
         ("s,solver", "Use given solver (--solvers for info)", cxxopts::value<std::string>())
         ("solvers", "List available solvers")
+        ("small-solver", "Use given solver for components of at most --small-size nodes", cxxopts::value<std::string>())
+        ("small-size", "Maximum size of components for --small-solver (default 64)", cxxopts::value<long>())
+        ("large-solver", "Use given solver for components of at least --large-size nodes", cxxopts::value<std::string>())
+        ("large-size", "Minimum size of components for --large-solver (default 100000)", cxxopts::value<long>())
         ("c,configure", "Additional configuration options for the solver", cxxopts::value<std::string>())
         ("w,workers", "Number of workers for parallel code", cxxopts::value<int>())
         ("z,timeout", "Number of seconds for timeout", cxxopts::value<int>())
+        ("memory", "Placement of large arrays (comma separated: hugepages, interleave, firsttouch)", cxxopts::value<std::string>())
+        ("reorder", "Reorder vertices of equal priority for locality (bfs, rcm)", cxxopts::value<std::string>())
         ;
 
     /* Add solvers */
@@ -241,29 +255,135 @@ int main(int argc, char **argv)
     out.push(timestamp_filter());
     out.push(std::cout);
 
+    /**
+     * If workers are requested, start Lace now, so the parser can also use the workers.
+     */
+
+    if (options.count("workers") and options["workers"].as<int>() >= 0) {
+        lace_start(options["workers"].as<int>(), 0);
+        out << "initialized Lace with " << lace_workers() << " workers" << std::endl;
+    }
+
+    /**
+     * Set the allocation policy before the game is allocated.
+     * (First touch uses the Lace workers, so it requires -w.)
+     */
+
+    if (options.count("memory")) {
+        int policy = MEM_DEFAULT;
+        std::stringstream ss(options["memory"].as<std::string>());
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item == "hugepages") policy |= MEM_HUGEPAGES;
+            else if (item == "interleave") policy |= MEM_INTERLEAVE;
+            else if (item == "firsttouch") policy |= MEM_FIRSTTOUCH;
+            else {
+                out << "unknown memory policy: " << item << std::endl;
+                return -1;
+            }
+        }
+        set_memory_policy(policy);
+    }
+
+    /**
+     * Check the solvers for small and large components before reading the game.
+     */
+
+    for (const char *opt : {"small-solver", "large-solver"}) {
+        if (options.count(opt) and Solvers::getSolverIDs().count(options[opt].as<std::string>()) == 0) {
+            out << "unknown solver: " << options[opt].as<std::string>() << std::endl;
+            return -1;
+        }
+    }
+
+    /**
+     * Check the reorder method before reading the game.
+     */
+
+    Game::reorder_method reorder = Game::REORDER_BFS;
+    if (options.count("reorder")) {
+        const std::string method = options["reorder"].as<std::string>();
+        if (method == "bfs") reorder = Game::REORDER_BFS;
+        else if (method == "rcm") reorder = Game::REORDER_RCM;
+        else {
+            out << "unknown reorder method: " << method << std::endl;
+            return -1;
+        }
+    }
+
     /**
      * STEP 1
      * Read the game that must be solved.
-     * (Supports bz2 and gz compression.)
+     * (Supports bz2 and gz compression, the binary .pgb format, the compact .pgc format,
+     *  and parity automata in the extended HOA format (.hoa/.ehoa) for synthesis.)
      */
 
     Game pg;
+    int initial = -1; // the vertex of the initial state of an automaton
+
+    // the text parsers can load the game directly in order of priority (see STEP 4),
+    // unless the game is first needed in the order of the input file
+    std::vector<int> mapping;
+    bool sorted = false;
+    const bool input_order = options.count("sol") or options.count("dot") or options.count("pgb") or options.count("pgc");
 
     try {
         if (options.count("input")) {
             std::string filename = options["input"].as<std::string>();
-            io::filtering_istream in;
-            if (boost::algorithm::ends_with(filename, ".bz2")) in.push(io::bzip2_decompressor());
-            if (boost::algorithm::ends_with(filename, ".gz")) in.push(io::gzip_decompressor());
-            std::ifstream file(filename, std::ios_base::binary);
-            in.push(file);
-            // time it
-            auto begin = wctime();
-            //pg = PGParser::parse_pgsolver(in, options.count("no-loops") == 0 and options.count("no") == 0);
-            pg = PGParser::parse_pgsolver_renumber(in, options.count("no-loops") == 0 and options.count("no") == 0);
-            auto end = wctime();
-            out << "parsing took " << std::fixed << (end-begin) << " sec." << std::endl;
-            file.close();
+            bool removeBadLoops = options.count("no-loops") == 0 and options.count("no") == 0;
+            // labels are only needed to print the solution, for the trace, or to write the game
+            bool labels = options.count("p") or options.count("t") or options.count("pgb") or options.count("pgc");
+            bool compressed = boost::algorithm::ends_with(filename, ".bz2") or boost::algorithm::ends_with(filename, ".gz");
+            bool compact = boost::algorithm::ends_with(filename, ".pgc") or boost::algorithm::ends_with(filename, ".pgc.gz") or boost::algorithm::ends_with(filename, ".pgc.bz2");
+            bool hoa = boost::algorithm::ends_with(filename, ".hoa") or boost::algorithm::ends_with(filename, ".ehoa");
+            struct stat st;
+            if (hoa) {
+                // parity automaton: the controller is player 0 (even)
+                std::ifstream file(filename);
+                if (!file) throw std::runtime_error("cannot open " + filename);
+                auto begin = wctime();
+                pg = PGParser::parse_ehoa(file, &initial);
+                auto end = wctime();
+                out << "parsing took " << std::fixed << (end-begin) << " sec." << std::endl;
+            } else if (boost::algorithm::ends_with(filename, ".pgb")) {
+                // binary game: map it into memory, no parsing required
+                auto begin = wctime();
+                pg = PGParser::parse_binary_file(filename, labels ? PGParser::LABELS_MAPPED : PGParser::LABELS_NONE);
+                auto end = wctime();
+                out << "loading took " << std::fixed << (end-begin) << " sec." << std::endl;
+            } else if (!compressed and !compact and stat(filename.c_str(), &st) == 0 and S_ISREG(st.st_mode)) {
+                // uncompressed regular file: map it into memory and parse it directly
+                auto begin = wctime();
+                pg = PGParser::parse_pgsolver_file(filename, removeBadLoops, labels ? PGParser::LABELS_MAPPED : PGParser::LABELS_NONE, input_order ? nullptr : &mapping);
+                sorted = !input_order;
+                auto end = wctime();
+                out << "parsing took " << std::fixed << (end-begin) << " sec." << std::endl;
+            } else if (compressed and !compact and stat(filename.c_str(), &st) == 0 and S_ISREG(st.st_mode) and decompress_fits(filename)) {
+                // compressed regular file: decompress it into memory (in parallel if possible), then parse the buffer
+                // (if the text may not fit in memory, the file is decompressed as a stream below)
+                auto begin = wctime();
+                decompressed_text text = decompress_file(filename);
+                auto middle = wctime();
+                pg = PGParser::parse_pgsolver_buffer(text.data != NULL ? text.data : "", text.size, removeBadLoops, labels ? PGParser::LABELS_COPY : PGParser::LABELS_NONE, input_order ? nullptr : &mapping);
+                sorted = !input_order;
+                auto end = wctime();
+                out << "decompressing took " << std::fixed << (middle-begin) << " sec." << std::endl;
+                out << "parsing took " << std::fixed << (end-middle) << " sec." << std::endl;
+            } else {
+                io::filtering_istream in;
+                if (boost::algorithm::ends_with(filename, ".bz2")) in.push(io::bzip2_decompressor());
+                if (boost::algorithm::ends_with(filename, ".gz")) in.push(io::gzip_decompressor());
+                std::ifstream file(filename, std::ios_base::binary);
+                in.push(file);
+                // time it
+                auto begin = wctime();
+                //pg = PGParser::parse_pgsolver(in, removeBadLoops);
+                if (compact) pg = PGParser::parse_compact(in, labels ? PGParser::LABELS_COPY : PGParser::LABELS_NONE);
+                else pg = PGParser::parse_pgsolver_renumber(in, removeBadLoops);
+                auto end = wctime();
+                out << "parsing took " << std::fixed << (end-begin) << " sec." << std::endl;
+                file.close();
+            }
         } else {
             pg = PGParser::parse_pgsolver_renumber(std::cin, options.count("no-loops") == 0 and options.count("no") == 0);
         }
@@ -302,16 +422,52 @@ int main(int argc, char **argv)
         out << "dot file written." << std::endl;
     }
 
+    /**
+     * If requested, write .pgb file
+     */
+
+    if (options.count("pgb")) {
+        std::ofstream file(options["pgb"].as<std::string>(), std::ios_base::binary);
+        pg.write_binary(file);
+        file.close();
+        out << "pgb file written." << std::endl;
+    }
+
+    /**
+     * If requested, write .pgc file
+     */
+
+    if (options.count("pgc")) {
+        std::ofstream file(options["pgc"].as<std::string>(), std::ios_base::binary);
+        pg.write_compact(file);
+        file.close();
+        out << "pgc file written." << std::endl;
+    }
+
     /**
      * STEP 4
      * Reindex the game so all nodes are in order of priority.
      * (Remember the mapping to reverse the reindex later.)
+     * If the parser already loaded the game in order, it also gave the mapping.
      */
 
-    int *mapping = new int[pg.nodecount()];
-    pg.sort(mapping);
+    if (!sorted) {
+        mapping.resize(pg.nodecount());
+        pg.sort(mapping.data());
+    }
     out << "parity game reindexed" << std::endl;
 
+    /**
+     * If requested, reorder the vertices of equal priority for locality.
+     * (The mapping is updated, so the output is in the original order.)
+     */
+
+    if (options.count("reorder")) {
+        double begin = wctime();
+        pg.reorder(reorder, mapping.data());
+        out << "reordering took " << std::fixed << (wctime()-begin) << " sec." << std::endl;
+    }
+
     /**
      * STEP 5
      * Configure the solver.
@@ -328,6 +484,7 @@ int main(int argc, char **argv)
     if (no or options.count("no-single")) en.setSolveSingle(false);
     if (no or options.count("no-loops")) en.setRemoveLoops(false);
     if (no or options.count("no-wcwc")) en.setRemoveWCWC(false);
+    if (options.count("par-wcwc")) en.setParallelWCWC(true);
 
     // solver
     if (options.count("solver")) {
@@ -339,8 +496,19 @@ int main(int argc, char **argv)
         }
     }
 
+    // solvers for small and large components
+    if (options.count("small-solver")) {
+        const long size = options.count("small-size") ? options["small-size"].as<long>() : 64;
+        en.setSmallSolver(options["small-solver"].as<std::string>(), size);
+    }
+    if (options.count("large-solver")) {
+        const long size = options.count("large-size") ? options["large-size"].as<long>() : 100000;
+        en.setLargeSolver(options["large-solver"].as<std::string>(), size);
+    }
+
     // solving options
     if (options.count("scc")) en.setBottomSCC(true);
+    if (options.count("no-views")) en.setSubgameViews(false);
     if (options.count("workers")) en.setWorkers(options["workers"].as<int>());
 
     if (options.count("configure")) {
@@ -392,7 +560,13 @@ int main(int argc, char **argv)
      * Revert reindex if we need to output.
      */
 
-    if (options.count("output") or options.count("p")) pg.permute(mapping);
+    if (options.count("output") or options.count("p") or initial != -1) pg.permute(mapping.data());
+
+    if (initial != -1 and pg.isSolved(initial)) {
+        // report if the specification of the automaton is realizable
+        if (pg.getWinner(initial) == 0) out << "initial state won by even (realizable)." << std::endl;
+        else out << "initial state won by odd (unrealizable)." << std::endl;
+    }
 
     if (options.count("output")) {
         // write solution to file
@@ -425,7 +599,7 @@ int main(int argc, char **argv)
         if (banner) out << std::endl;
     }
 
-    delete[] mapping;
+    if (lace_workers() != 0) lace_stop();
 
     resetsighandlers();
     return 0;
@@ -17,7 +17,7 @@
 #include <iostream>
 #include <memory>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 using namespace std;
 using namespace pg;
@@ -39,7 +39,7 @@ static int n, m;
  * Make bit <i> at base index <c> with given input/high priorities
  */
 void
-makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
+makeBit(GameBuilder &builder, const int c, int hipr, int inpr, int lopr, int i)
 {
     const int pl = hipr&1;
     int *inmy = pl ? in1 : in0;
@@ -52,12 +52,12 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
     string bitid_str = string_format(pl?"Odd-%d":"Even-%d", i);
     const char *bitid = bitid_str.c_str();
 
-    game.init_vertex(c,   hipr, pl,   string_format("%s-H", bitid));  // high
-    game.init_vertex(c+1, inpr, 1-pl, string_format("%s-I", bitid));  // gate (distraction/input)
-    game.init_vertex(c+2, lopr, 1-pl, string_format("%s-T", bitid));  // low (tangle)
-    game.vec_add_edge(c+1, c+2); // connect I -> T
-    game.vec_add_edge(c+2, c);   // connect T -> H
-    game.vec_add_edge(c, inmy[i == 0 ? n-1 : i-1]); // connect H -> I{(j-1) mod n}
+    builder.init_vertex(c,   hipr, pl,   string_format("%s-H", bitid));  // high
+    builder.init_vertex(c+1, inpr, 1-pl, string_format("%s-I", bitid));  // gate (distraction/input)
+    builder.init_vertex(c+2, lopr, 1-pl, string_format("%s-T", bitid));  // low (tangle)
+    builder.add_edge(c+1, c+2); // connect I -> T
+    builder.add_edge(c+2, c);   // connect T -> H
+    builder.add_edge(c, inmy[i == 0 ? n-1 : i-1]); // connect H -> I{(j-1) mod n}
 
     int d = c + 3;
 
@@ -66,24 +66,24 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
          * Create connectors (to higher bits)
          */
 
-        game.vec_add_edge(c+2, d); // connect T -> chain
+        builder.add_edge(c+2, d); // connect T -> chain
         for (int j=0; j<i; j++) {
-            game.init_vertex(d  , lopr-1, pl,   string_format("%s-S-%d", bitid, j)); // selector
-            game.init_vertex(d+1, lopr-1, 1-pl, string_format("%s-A-%d", bitid, j)); // exit one (even)
-            game.init_vertex(d+2, lopr-1, 1-pl, string_format("%s-B-%d", bitid, j)); // exit two (odd)
+            builder.init_vertex(d  , lopr-1, pl,   string_format("%s-S-%d", bitid, j)); // selector
+            builder.init_vertex(d+1, lopr-1, 1-pl, string_format("%s-A-%d", bitid, j)); // exit one (even)
+            builder.init_vertex(d+2, lopr-1, 1-pl, string_format("%s-B-%d", bitid, j)); // exit two (odd)
 
-            game.vec_add_edge(d, d+1);       // connect Sj -> Aj
-            game.vec_add_edge(d, d+2);       // connect Sj -> Bj
-            game.vec_add_edge(d+1, d+3);  // connect Aj -> S{j+1}
-            game.vec_add_edge(d+2, d+3);  // connect Bj -> S{j+1}
-            game.vec_add_edge(d+1, inmy[j]); // connect Aj -> <my> Ij
-            game.vec_add_edge(d+2, inop[j]); // connect Bj -> <their> Ij
+            builder.add_edge(d, d+1);        // connect Sj -> Aj
+            builder.add_edge(d, d+2);        // connect Sj -> Bj
+            builder.add_edge(d+1, d+3);   // connect Aj -> S{j+1}
+            builder.add_edge(d+2, d+3);   // connect Bj -> S{j+1}
+            builder.add_edge(d+1, inmy[j]); // connect Aj -> <my> Ij
+            builder.add_edge(d+2, inop[j]); // connect Bj -> <their> Ij
 
             d += 3;
         }
 
-        game.init_vertex(d, lopr+2, pl, string_format("%s-Z", bitid));
-        game.vec_add_edge(d, c+2);
+        builder.init_vertex(d, lopr+2, pl, string_format("%s-Z", bitid));
+        builder.add_edge(d, c+2);
         d += 1;
     }
 
@@ -96,26 +96,26 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
          * Create connectors (to higher bits)
          */
 
-        game.vec_add_edge(c+2, d); // connect T -> chain
+        builder.add_edge(c+2, d); // connect T -> chain
         for (int j=0; j<i; j++) {
-            game.init_vertex(d  , lopr-1, pl,   string_format("%s-%d-S-%d", bitid, k, j)); // selector
-            game.init_vertex(d+1, lopr-1, 1-pl, string_format("%s-%d-A-%d", bitid, k, j)); // exit one (even)
-            game.init_vertex(d+2, lopr-1, 1-pl, string_format("%s-%d-B-%d", bitid, k, j)); // exit two (odd)
+            builder.init_vertex(d  , lopr-1, pl,   string_format("%s-%d-S-%d", bitid, k, j)); // selector
+            builder.init_vertex(d+1, lopr-1, 1-pl, string_format("%s-%d-A-%d", bitid, k, j)); // exit one (even)
+            builder.init_vertex(d+2, lopr-1, 1-pl, string_format("%s-%d-B-%d", bitid, k, j)); // exit two (odd)
 
-            game.vec_add_edge(d, d+1);       // connect Sj -> Aj
-            game.vec_add_edge(d, d+2);       // connect Sj -> Bj
-            game.vec_add_edge(d+1, d+3);  // connect Aj -> S{j+1}
-            game.vec_add_edge(d+2, d+3);  // connect Bj -> S{j+1}
-            game.vec_add_edge(d+1, inmy[j]); // connect Aj -> <my> Ij
-            game.vec_add_edge(d+2, inop[j]); // connect Bj -> <their> Ij
+            builder.add_edge(d, d+1);        // connect Sj -> Aj
+            builder.add_edge(d, d+2);        // connect Sj -> Bj
+            builder.add_edge(d+1, d+3);   // connect Aj -> S{j+1}
+            builder.add_edge(d+2, d+3);   // connect Bj -> S{j+1}
+            builder.add_edge(d+1, inmy[j]); // connect Aj -> <my> Ij
+            builder.add_edge(d+2, inop[j]); // connect Bj -> <their> Ij
 
             d += 3;
         }
 
         const int pr = lopr + 2*(k-i+1);
-        game.init_vertex(d, pr, pl, string_format("%s-%d-Z", bitid, k)); // todo fix priority
-        game.vec_add_edge(d, c+2); // dv -> first selector!
-        game.vec_add_edge(d, inop[k]); // dv -> ...-I
+        builder.init_vertex(d, pr, pl, string_format("%s-%d-Z", bitid, k)); // todo fix priority
+        builder.add_edge(d, c+2); // dv -> first selector!
+        builder.add_edge(d, inop[k]); // dv -> ...-I
 
         d += 1;
     }
@@ -161,8 +161,7 @@ main(int argc, char** argv)
      * Create game...
      */
 
-    Game game(size);
-    game.vec_init();
+    GameBuilder builder(size);
 
     /**
      * Create the two counters
@@ -173,12 +172,12 @@ main(int argc, char** argv)
     int toppo = (n+3)*n+6*n; // N*N + 9N actually
     for (int i=0; i<n; i++) {
         int lo = 2;// + (2*n-i+1)*i + 2*i;
-        makeBit(game, hi0[i], toppo,   toppo-2*n-1, lo, i);
-        makeBit(game, hi1[i], toppo-1, toppo-2*n-2, lo + 1, i);
+        makeBit(builder, hi0[i], toppo,   toppo-2*n-1, lo, i);
+        makeBit(builder, hi1[i], toppo-1, toppo-2*n-2, lo + 1, i);
         toppo -= 2;
     }
 
-    game.vec_finish();
+    Game game = builder.finish();
     int mapping[game.nodecount()];
     game.sort(mapping);
     game.renumber();
@@ -17,7 +17,7 @@
 #include <iostream>
 #include <memory>
 
-#include "oink/game.hpp"
+#include "oink/gamebuilder.hpp"
 
 #define DOUBLEDISTRACTION 0
 
@@ -41,7 +41,7 @@ static int n, m;
  * Make bit <i> at base index <c> with given input/high priorities
  */
 void
-makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
+makeBit(GameBuilder &builder, const int c, int hipr, int inpr, int lopr, int i)
 {
     const int pl = hipr&1;
     int* _in = pl == 0 ? in1 : in0; // select _in of opponent
@@ -52,21 +52,21 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
 
     const char *plch = pl ? "Odd-" : "Even-";
 
-    game.init_vertex(c,   hipr,   pl,   string_format("%s%d-H", plch, i));  // high
-    game.init_vertex(c+1, lopr,   1-pl, string_format("%s%d-T", plch, i));  // low (tangle)
-    game.init_vertex(c+2, inpr,   1-pl, string_format("%s%d-L", plch, i));  // gate (distraction/input)
+    builder.init_vertex(c,   hipr,   pl,   string_format("%s%d-H", plch, i));  // high
+    builder.init_vertex(c+1, lopr,   1-pl, string_format("%s%d-T", plch, i));  // low (tangle)
+    builder.init_vertex(c+2, inpr,   1-pl, string_format("%s%d-L", plch, i));  // gate (distraction/input)
 #if DOUBLEDISTRACTION
-    game.init_vertex(c+3, inpr,   1-pl, string_format("%s%d-LL", plch, i));  // gate (distraction/input)
+    builder.init_vertex(c+3, inpr,   1-pl, string_format("%s%d-LL", plch, i));  // gate (distraction/input)
 #endif
 
-    game.vec_add_edge(c+1, c);   // from tangle to top
+    builder.add_edge(c+1, c);    // from tangle to top
 #if DOUBLEDISTRACTION
-    game.vec_add_edge(c+2, c+3); // from input/distraction to tangle
-    game.vec_add_edge(c+3, c+1); // from input/distraction to tangle
-    game.vec_add_edge(c+1, c+4); // from tangle to first connector
+    builder.add_edge(c+2, c+3); // from input/distraction to tangle
+    builder.add_edge(c+3, c+1); // from input/distraction to tangle
+    builder.add_edge(c+1, c+4); // from tangle to first connector
 #else
-    game.vec_add_edge(c+2, c+1); // from input/distraction to tangle
-    game.vec_add_edge(c+1, c+3); // from tangle to first connector
+    builder.add_edge(c+2, c+1); // from input/distraction to tangle
+    builder.add_edge(c+1, c+3); // from tangle to first connector
 #endif
 
     /**
@@ -76,22 +76,22 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
     for (int j=0; j<i; j++) {
         const int d = c + 3 + DOUBLEDISTRACTION + 3*j;
 
-        game.init_vertex(d  , lopr-1, pl,   string_format("%s%d-S-%d", plch, i, j)); // selector
-        game.init_vertex(d+1, lopr-1, 1-pl, string_format("%s%d-A-%d", plch, i, j)); // exit one (even)
-        game.init_vertex(d+2, lopr-1, 1-pl, string_format("%s%d-B-%d", plch, i, j)); // exit two (odd)
+        builder.init_vertex(d  , lopr-1, pl,   string_format("%s%d-S-%d", plch, i, j)); // selector
+        builder.init_vertex(d+1, lopr-1, 1-pl, string_format("%s%d-A-%d", plch, i, j)); // exit one (even)
+        builder.init_vertex(d+2, lopr-1, 1-pl, string_format("%s%d-B-%d", plch, i, j)); // exit two (odd)
 
-        game.vec_add_edge(d, d+1);  // s to one
-        game.vec_add_edge(d, d+2);  // s to two
+        builder.add_edge(d, d+1);   // s to one
+        builder.add_edge(d, d+2);   // s to two
 
-        game.vec_add_edge(d+1, d+3); // one to next selector
-        game.vec_add_edge(d+2, d+3); // two to next selector
+        builder.add_edge(d+1, d+3); // one to next selector
+        builder.add_edge(d+2, d+3); // two to next selector
 
         int *ina = pl ? in1 : in0;
         int *inb = pl ? in0 : in1;
-        game.vec_add_edge(d+1, ina[j]); // one to even input of bit <j>
-        game.vec_add_edge(d+2, inb[j]); // two to odd input of bit <j>
+        builder.add_edge(d+1, ina[j]); // one to even input of bit <j>
+        builder.add_edge(d+2, inb[j]); // two to odd input of bit <j>
 
-        // for (int j = i+pl; j<n; j++) game.vec_add_edge(d, _in[j]);
+        // for (int j = i+pl; j<n; j++) builder.add_edge(d, _in[j]);
     }
 
     /**
@@ -99,17 +99,17 @@ makeBit(Game &game, const int c, int hipr, int inpr, int lopr, int i)
      */
 
 #if 0
-    game.vec_add_edge(c, (pl == 0 ? in0 : in1)[(i+n-1)%n]-1);
+    builder.add_edge(c, (pl == 0 ? in0 : in1)[(i+n-1)%n]-1);
 #else
-    game.vec_add_edge(c, (pl == 0 ? in0 : in1)[(i+n-1)%n]);
+    builder.add_edge(c, (pl == 0 ? in0 : in1)[(i+n-1)%n]);
 #endif
 
     // even (lower or same bit)
     // odd (only to lower bits)
     int x = c+3+DOUBLEDISTRACTION+3*i;
-    game.init_vertex(x, lopr-1, pl, string_format("%s%d-Z", plch, i));  // Z (distracted)
-    game.vec_add_edge(x, c+1); // from Z to tangle
-    for (int j = i+1-pl; j<n; j++) game.vec_add_edge(x, _in[j]);
+    builder.init_vertex(x, lopr-1, pl, string_format("%s%d-Z", plch, i));  // Z (distracted)
+    builder.add_edge(x, c+1); // from Z to tangle
+    for (int j = i+1-pl; j<n; j++) builder.add_edge(x, _in[j]);
 }
 
 int
@@ -152,8 +152,7 @@ main(int argc, char** argv)
      * Create game...
      */
 
-    Game game(size);
-    game.vec_init();
+    GameBuilder builder(size);
 
     /**
      * Create the two counters
@@ -166,21 +165,21 @@ main(int argc, char** argv)
 #if 0
     int toppo = (n+3)*n+6*n; // N*N + 9N actually
     for (int i=0; i<n; i++) {
-        makeBit(game, hi0[i], toppo,   toppo-1, lo += 2*(n+1-i), i);
-        makeBit(game, hi1[i], toppo-3, toppo-4, lo + 1, i);
+        makeBit(builder, hi0[i], toppo,   toppo-1, lo += 2*(n+1-i), i);
+        makeBit(builder, hi1[i], toppo-3, toppo-4, lo + 1, i);
         toppo -= 6;
     }
 #else
     int toppo = (n+3)*n+6*n; // N*N + 9N actually
     for (int i=0; i<n; i++) {
-        // makeBit(game, hi0[i], toppo,   toppo-2*n-1, lo += 2*(n+1-i), i);
-        makeBit(game, hi0[i], toppo-2, toppo-2*n-3, lo + 2, i);
-        makeBit(game, hi1[i], toppo-1, toppo-2*n-2, lo + 1, i);
+        // makeBit(builder, hi0[i], toppo,   toppo-2*n-1, lo += 2*(n+1-i), i);
+        makeBit(builder, hi0[i], toppo-2, toppo-2*n-3, lo + 2, i);
+        makeBit(builder, hi1[i], toppo-1, toppo-2*n-2, lo + 1, i);
         toppo -= 2;
     }
 #endif
 
-    game.vec_finish();
+    Game game = builder.finish();
     game.sort();
     game.renumber();
     game.write_pgsolver(std::cout);
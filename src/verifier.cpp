@@ -194,7 +194,7 @@ Verifier::verify(bool fullgame, bool even, bool odd)
             }
 
             bool cycles = scc_size > 1 or game.getStrategy(v) == v or
-                (game.getStrategy(v) == -1 and game.has_edge(v, v));
+                (game.getStrategy(v) == -1 and game.has_selfloop(v));
 
             if (cycles && (max_prio&1) == (prio&1)) {
                 /**
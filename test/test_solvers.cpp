@@ -14,11 +14,15 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <climits>
 #include <csignal>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <set>
 #include <sstream>
 #include <sys/time.h>
 #include <optional>
@@ -32,6 +36,8 @@
 #include <boost/process.hpp>
 
 #include "tools/cxxopts.hpp"
+#include "tools/decompress.hpp"
+#include "oink/gamebuilder.hpp"
 #include "oink/oink.hpp"
 #include "oink/solvers.hpp"
 #include "oink/solver.hpp"
@@ -49,7 +55,15 @@ bool opt_compress = false;
 bool opt_single = false;
 bool opt_loops = false;
 bool opt_wcwc = false;
+bool opt_scc = false;
 bool opt_sort = false;
+bool opt_roundtrip = false;
+bool opt_builder = false;
+bool opt_wcwc_par = false;
+bool opt_reorder = false;
+bool opt_fused = false;
+bool opt_parser = false;
+bool opt_flush_par = false;
 int opt_workers = 0;
 int opt_trace = -1;
 std::optional<std::string> opt_solver_opts = {};
@@ -164,7 +178,9 @@ test_solver(Game &game, const std::string& solverid, double &time, std::ostream
     solver.setSolveSingle(opt_single);
     solver.setRemoveLoops(opt_loops);
     solver.setRemoveWCWC(opt_wcwc);
+    solver.setBottomSCC(opt_scc);
     solver.setWorkers(opt_workers);
+    if (opt_flush_par) solver.setParallelFlush(0);
     solver.setSolver(solverid);
     if (opt_trace >= 0) solver.setTrace(opt_trace);
     else solver.setTrace(0);
@@ -193,6 +209,412 @@ test_solver(Game &game, const std::string& solverid, double &time, std::ostream
 }
 
 
+/**
+ * Solve the winner-controlled winning cycles of the game with the sequential and the parallel algorithm
+ * (the parallel algorithm only runs if Lace is running), verify both partial solutions, and check that
+ * they solve the same vertices with the same winners.
+ */
+int
+test_wcwc_parallel(Game &game, std::ostream &log)
+{
+    game.reset_solution();
+    game.ensure_sorted();
+
+    Game seq(game), par(game);
+    for (Game *g : {&seq, &par}) {
+        Oink oink(*g, log);
+        oink.setRenumber(); // default
+        oink.setSolveSingle(false);
+        oink.setRemoveLoops(false);
+        oink.setRemoveWCWC(true);
+        oink.setParallelWCWC(g == &par);
+        oink.setWorkers(opt_workers);
+        oink.setTrace(opt_trace >= 0 ? opt_trace : 0);
+        try {
+            oink.run(); // no solver, so only preprocessing
+        } catch (pg::Error &err) {
+            log << "solver error: " << err.what() << std::endl;
+            return 1;
+        }
+        try {
+            Game check(game);
+            check.copy_solution(*g);
+            Verifier v(check, log);
+            v.verify(false, true, true);
+        } catch (std::runtime_error &err) {
+            log << "verification error (" << (g == &par ? "parallel" : "sequential") << "): " << err.what() << std::endl;
+            return 2;
+        }
+    }
+
+    for (int v=0; v<game.vertexcount(); v++) {
+        if (seq.isSolved(v) != par.isSolved(v)) {
+            log << "vertex " << v << " is only solved by the " << (seq.isSolved(v) ? "sequential" : "parallel") << " algorithm" << std::endl;
+            return 3;
+        }
+        if (seq.isSolved(v) and seq.getWinner(v) != par.getWinner(v)) {
+            log << "vertex " << v << " has different winners" << std::endl;
+            return 3;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Preprocess the game (solve self-loops and winner-controlled winning cycles, and attract to them)
+ * with the sequential and with the parallel flush, verify both partial solutions, and check that they
+ * solve the same vertices with the same winners (the attractors are unique, the strategies are not).
+ * The parallel flush only runs if Lace is running (with -w).
+ */
+int
+test_flush_parallel(Game &game, std::ostream &log)
+{
+    game.reset_solution();
+    game.ensure_sorted();
+
+    Game seq(game), par(game);
+    for (Game *g : {&seq, &par}) {
+        Oink oink(*g, log);
+        oink.setRenumber(); // default
+        oink.setSolveSingle(false);
+        oink.setRemoveLoops(true);
+        oink.setRemoveWCWC(true);
+        oink.setParallelFlush(g == &par ? 0 : LONG_MAX);
+        oink.setWorkers(opt_workers);
+        oink.setTrace(opt_trace >= 0 ? opt_trace : 0);
+        try {
+            oink.run(); // no solver, so only preprocessing
+        } catch (pg::Error &err) {
+            log << "solver error: " << err.what() << std::endl;
+            return 1;
+        }
+        try {
+            Game check(game);
+            check.copy_solution(*g);
+            Verifier v(check, log);
+            v.verify(false, true, true);
+        } catch (std::runtime_error &err) {
+            log << "verification error (" << (g == &par ? "parallel" : "sequential") << "): " << err.what() << std::endl;
+            return 2;
+        }
+    }
+
+    for (int v=0; v<game.vertexcount(); v++) {
+        if (seq.isSolved(v) != par.isSolved(v)) {
+            log << "vertex " << v << " is only attracted by the " << (seq.isSolved(v) ? "sequential" : "parallel") << " flush" << std::endl;
+            return 3;
+        }
+        if (seq.isSolved(v) and seq.getWinner(v) != par.getWinner(v)) {
+            log << "vertex " << v << " has different winners" << std::endl;
+            return 3;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reorder the game with the sequential and with the parallel code (see Game::set_parallel_reorder):
+ * apply a random permutation, sort the vertices by priority and rebuild the in-edges. Check that both
+ * give the same mapping and the same game. The parallel code only runs if Lace is running (with -w).
+ */
+int
+test_reorder(Game &game, std::ostream &log)
+{
+    game.reset_solution();
+    const int n = game.vertexcount();
+    std::vector<int> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), std::mt19937(n));
+
+    const size_t threshold = Game::get_parallel_reorder();
+    std::vector<int> mapping[2];
+    std::stringstream result[2];
+    for (int par=0; par<2; par++) {
+        Game::set_parallel_reorder(par ? 0 : SIZE_MAX);
+        Game g(game);
+        std::vector<int> p(perm); // (the sequential permute consumes the mapping)
+        g.permute(p.data());
+        mapping[par].resize(n);
+        g.sort(mapping[par].data());
+        g.build_in_array(true);
+        g.write_pgsolver(result[par]);
+        for (int v=0; v<n; v++) {
+            result[par] << v << " <-";
+            for (int from : g.preds(v)) result[par] << " " << from;
+            result[par] << ";" << std::endl;
+        }
+    }
+    Game::set_parallel_reorder(threshold);
+
+    if (mapping[0] != mapping[1]) {
+        log << "parallel sort gives a different mapping" << std::endl;
+        return 3;
+    }
+    if (result[0].str() != result[1].str()) {
+        log << "parallel permute or build_in_array gives a different game" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+/**
+ * Load the pgsolver file in order of priority (the fused path of the parser, which also builds the in-edges)
+ * and check that this gives the same mapping and the same game as parsing the file and then using Game::sort.
+ */
+int
+test_fused(const std::string &filename, std::ostream &log)
+{
+    std::vector<int> mapping[2];
+    std::stringstream result[2];
+    try {
+        for (int fused=0; fused<2; fused++) {
+            Game g;
+            if (fused) {
+                g = PGParser::parse_pgsolver_file(filename, opt_loops, PGParser::LABELS_COPY, &mapping[fused]);
+            } else {
+                g = PGParser::parse_pgsolver_file(filename, opt_loops);
+                mapping[fused].resize(g.vertexcount());
+                g.sort(mapping[fused].data());
+                g.build_in_array(false);
+            }
+            g.write_pgsolver(result[fused]);
+            for (int v=0; v<g.vertexcount(); v++) {
+                result[fused] << v << " <-";
+                for (int from : g.preds(v)) result[fused] << " " << from;
+                result[fused] << ";" << std::endl;
+            }
+        }
+    } catch (std::runtime_error &err) {
+        log << "parse error: " << err.what() << std::endl;
+        return 3;
+    }
+
+    if (mapping[0] != mapping[1]) {
+        log << "loading in order of priority gives a different mapping" << std::endl;
+        return 3;
+    }
+    if (result[0].str() != result[1].str()) {
+        log << "loading in order of priority gives a different game" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+/**
+ * Parse the pgsolver text with the stream parser, with the sequential buffer parser and with the parallel
+ * buffer parser in small chunks (see PGParser::set_parallel_parse), and check that they give the same game.
+ * Then check the sequential and the parallel buffer parser on variations of the text: with the highest id
+ * in the header and a "start" line with a comment, with labels, with labels that contain "; " so that
+ * chunks can end inside a label (the parallel parser then falls back to the sequential parser), and with
+ * a duplicate id, which must give the same error. The parallel parser only runs if Lace is running (with -w).
+ */
+int
+test_parser(const std::string &text, std::ostream &log)
+{
+    // parse with the stream parser (0), the sequential buffer parser (1) or the parallel buffer parser (2)
+    auto parse = [] (const std::string &str, int mode) {
+        std::stringstream res;
+        try {
+            Game g;
+            if (mode == 0) {
+                std::istringstream in(str);
+                g = PGParser::parse_pgsolver_renumber(in, opt_loops);
+            } else {
+                PGParser::set_parallel_parse(mode == 2 ? 0 : SIZE_MAX);
+                g = PGParser::parse_pgsolver_buffer(str.data(), str.size(), opt_loops);
+            }
+            g.write_pgsolver(res);
+        } catch (std::runtime_error &err) {
+            res << "error: " << err.what() << std::endl;
+        }
+        return res.str();
+    };
+
+    const size_t threshold = PGParser::get_parallel_parse();
+    const std::string seq = parse(text, 1);
+    if (parse(text, 0) != seq) {
+        PGParser::set_parallel_parse(threshold);
+        log << "the stream parser gives a different game" << std::endl;
+        return 3;
+    }
+
+    // write the variations of the text
+    std::istringstream in(seq);
+    Game game = PGParser::parse_pgsolver_renumber(in, false);
+    const int n = game.vertexcount();
+    std::string variants[4];
+    for (int var=0; var<4; var++) {
+        std::stringstream out;
+        out << "parity " << (var == 0 ? n-1 : n) << ";" << std::endl;
+        if (var == 0) out << "start 0; the initial vertex, and this comment is ignored" << std::endl;
+        for (int v=0; v<n; v++) {
+            const int id = (var == 3 and v == n-1) ? 0 : v; // (the last vertex gets a duplicate id)
+            out << id << " " << game.priority(id) << " " << game.owner(id) << " ";
+            for (auto curedge = game.outs(id); *curedge != -1; curedge++) {
+                if (curedge != game.outs(id)) out << ",";
+                out << *curedge;
+            }
+            if (var == 1 and (v&1)) out << " \"vertex " << v << "\"";
+            if (var == 2) out << " \"vertex " << v << "; owned by player " << game.owner(v) << ";\n\"";
+            out << ";" << std::endl;
+        }
+        variants[var] = out.str();
+    }
+
+    int res = 0;
+    for (int var=0; var<4 and res == 0; var++) {
+        if (parse(variants[var], 1) != parse(variants[var], 2)) {
+            log << "the parallel parser gives a different " << (var == 3 ? "error" : "game") << " on variation " << var << std::endl;
+            res = 3;
+        }
+    }
+    PGParser::set_parallel_parse(threshold);
+    return res;
+}
+
+/**
+ * Write the game in the binary and compact formats and read it back, and check that it is the
+ * same game (by comparing the pgsolver output, with sorted successors for the compact format).
+ */
+int
+test_roundtrip(Game &game, std::ostream &log)
+{
+    std::stringstream orig;
+    game.write_pgsolver(orig);
+
+    auto path = fs::unique_path();
+    std::ofstream file(path.native(), std::ios_base::binary);
+    game.write_binary(file);
+    file.close();
+    std::stringstream pgb;
+    try {
+        Game g = PGParser::parse_binary_file(path.native());
+        g.write_pgsolver(pgb);
+    } catch (std::runtime_error &err) {
+        log << "pgb error: " << err.what() << std::endl;
+    }
+    fs::remove(path);
+    if (pgb.str() != orig.str()) {
+        log << "pgb round trip gives a different game" << std::endl;
+        return 3;
+    }
+
+    // the compact format stores the successors in ascending order
+    Game sorted(game);
+    sorted.sort_succs();
+    std::stringstream orig_sorted, compact, pgc;
+    sorted.write_pgsolver(orig_sorted);
+    game.write_compact(compact);
+    try {
+        Game g = PGParser::parse_compact(compact);
+        g.write_pgsolver(pgc);
+    } catch (std::runtime_error &err) {
+        log << "pgc error: " << err.what() << std::endl;
+    }
+    if (pgc.str() != orig_sorted.str()) {
+        log << "pgc round trip gives a different game" << std::endl;
+        return 3;
+    }
+
+    return 0;
+}
+
+/**
+ * Build a random game of <n> vertices with GameBuilder, adding the edges in random order with duplicates
+ * and self-loops, and leaving every third vertex uninitialized. Check that the game has no duplicate edges,
+ * that the successors are in ascending order, that the self-loop flags are set, and that the uninitialized
+ * vertices have priority 0, owner Even and no label. Games with at least 2^16 vertices are built in parallel
+ * if Lace is running (see Game::set_parallel_reorder).
+ */
+int
+test_builder(int n, std::ostream &log)
+{
+    std::mt19937 rng(n);
+    std::vector<std::set<int>> succs(n);
+    std::vector<std::pair<int, int>> edges;
+    for (int v=0; v<n; v++) {
+        const int degree = 1 + rng() % 4;
+        for (int i=0; i<degree; i++) {
+            const int to = rng() % 8 == 0 ? v : rng() % n;
+            succs[v].insert(to);
+            edges.emplace_back(v, to);
+            if (rng() % 4 == 0) edges.emplace_back(v, to); // duplicate
+        }
+    }
+    std::shuffle(edges.begin(), edges.end(), rng);
+
+    GameBuilder builder;
+    std::vector<int> priorities(n, 0), owners(n, 0);
+    std::vector<std::string> labels(n);
+    for (int v=n-1; v>=0; v--) {
+        if (v % 3 == 0) continue;
+        priorities[v] = rng() % n;
+        owners[v] = rng() % 2;
+        if (v % 2 == 0) labels[v] = "v" + std::to_string(v);
+        builder.init_vertex(v, priorities[v], owners[v], labels[v]);
+    }
+    // the builder must have all <n> vertices before finish (this keeps the defaults of the last vertex)
+    if (builder.vertexcount() < n) builder.init_vertex(n-1, 0, 0);
+    // add half of the edges one by one, and the others with add_edges
+    const size_t half = edges.size() / 2;
+    for (size_t i=0; i<half; i++) builder.add_edge(edges[i].first, edges[i].second);
+    std::vector<int> from, to;
+    for (size_t i=half; i<edges.size(); i++) {
+        from.push_back(edges[i].first);
+        to.push_back(edges[i].second);
+    }
+    builder.add_edges(from.data(), to.data(), from.size());
+
+    Game game = builder.finish(true);
+    if (game.vertexcount() != n) {
+        log << "game has " << game.vertexcount() << " vertices instead of " << n << std::endl;
+        return 3;
+    }
+    if (!game.succs_sorted()) {
+        log << "game does not record that the successors are sorted" << std::endl;
+        return 3;
+    }
+    size_t n_edges = 0;
+    for (int v=0; v<n; v++) {
+        n_edges += succs[v].size();
+        if (game.priority(v) != priorities[v] or game.owner(v) != owners[v] or game.rawlabel(v) != labels[v]) {
+            log << "vertex " << v << " has the wrong priority, owner or label" << std::endl;
+            return 3;
+        }
+        if (!std::equal(game.succs(v).begin(), game.succs(v).end(), succs[v].begin(), succs[v].end())) {
+            log << "vertex " << v << " has the wrong successors (duplicate, missing or not in ascending order)" << std::endl;
+            return 3;
+        }
+        if (game.has_selfloop(v) != (succs[v].count(v) != 0)) {
+            log << "vertex " << v << " has the wrong self-loop flag" << std::endl;
+            return 3;
+        }
+        for (int u : game.preds(v)) {
+            if (succs[u].count(v) == 0) {
+                log << "vertex " << v << " has the wrong predecessors" << std::endl;
+                return 3;
+            }
+        }
+    }
+    if ((size_t)game.edgecount() != n_edges) {
+        log << "game has " << game.edgecount() << " edges instead of " << n_edges << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+/**
+ * Check if the file name has the extension of a parity game format, so it must be parsed.
+ */
+static bool
+is_game_file(const std::string &filename)
+{
+    for (const char *ext : {".pg", ".pgb", ".pgc", ".gz", ".bz2", ".hoa", ".ehoa"}) {
+        if (boost::algorithm::ends_with(filename, ext)) return true;
+    }
+    return false;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -207,7 +629,15 @@ main(int argc, char **argv)
         ("single", "Enable preprocessor \"single\" (solve single-parity games)")
         ("loops", "Enable preprocessor \"loops\" (remove/solve self-loops)")
         ("wcwc", "Enable preprocessor \"wcwc\" (solve winner-controlled winning cycles)")
+        ("scc", "Solve per SCC, starting from the bottom SCCs (concurrently with -w)")
         ("sort", "Sort the list of files for solving (if given a list of files)")
+        ("roundtrip", "Check that every game is the same after writing and reading it in the binary and compact formats")
+        ("wcwcpar", "Check that the sequential and the parallel preprocessor \"wcwc\" solve the same vertices (with -w)")
+        ("reorder", "Check that sorting, permuting and building the in-edges in parallel (with -w) gives the same game")
+        ("flushpar", "Flush in parallel (with -w) on every game, and check that the parallel flush attracts the same vertices")
+        ("fused", "Check that loading pgsolver files in order of priority gives the same game and mapping as sorting them")
+        ("parser", "Check that the stream parser and the sequential and parallel (with -w) buffer parsers give the same game")
+        ("builder", "Check the games made by GameBuilder, for a small game and a game that is built in parallel (with -w 0)")
         ;
     opts.add_options("Random games")
         ("count", "Number of random games", cxxopts::value<int>()->default_value("100"))
@@ -263,7 +693,15 @@ main(int argc, char **argv)
     opt_single = options.count("single") != 0;
     opt_loops = options.count("loops") != 0;
     opt_wcwc = options.count("wcwc") != 0;
+    opt_scc = options.count("scc") != 0;
     opt_sort = options.count("sort") != 0;
+    opt_roundtrip = options.count("roundtrip") != 0;
+    opt_builder = options.count("builder") != 0;
+    opt_wcwc_par = options.count("wcwcpar") != 0;
+    opt_reorder = options.count("reorder") != 0;
+    opt_fused = options.count("fused") != 0;
+    opt_parser = options.count("parser") != 0;
+    opt_flush_par = options.count("flushpar") != 0;
     if (options.count("workers")) opt_workers = options["workers"].as<int>();
     if (options.count("trace")) opt_trace = options["trace"].as<int>();
 
@@ -286,7 +724,14 @@ main(int argc, char **argv)
             std::cout << " '" << e << "'";
         }
     }
-    if (solvers.size() == 0) {
+    if (opt_roundtrip) std::cout << " (round trip)";
+    if (opt_builder) std::cout << " (game builder)";
+    if (opt_wcwc_par) std::cout << " (wcwc sequential/parallel)";
+    if (opt_reorder) std::cout << " (reorder sequential/parallel)";
+    if (opt_fused) std::cout << " (load in order)";
+    if (opt_parser) std::cout << " (stream/sequential/parallel parser)";
+    if (opt_flush_par) std::cout << " (flush sequential/parallel)";
+    if (solvers.size() == 0 and !opt_roundtrip and !opt_builder and !opt_wcwc_par and !opt_reorder and !opt_fused and !opt_flush_par and !opt_parser) {
         std::cout << " (none)" << std::endl << std::endl;
         std::cout << "Use --help for program options." << std::endl << std::endl;
         std::cout << "- Select one or more solvers" << std::endl;
@@ -322,6 +767,19 @@ main(int argc, char **argv)
         sgood[id] = 0;
     }
 
+    if (opt_builder) {
+        for (int n : {1000, 1<<17}) {
+            std::cout << "game builder (" << n << " vertices): " << std::flush;
+            log.str("");
+            if (test_builder(n, opt_trace == -1 ? log : std::cout) == 0) {
+                std::cout << "\033[38;5;82mgood\033[m" << std::endl;
+            } else {
+                final_res = 3;
+                std::cout << "\033[38;5;196mbad\033[m (" << log.str().substr(0, log.str().find('\n')) << ")" << std::endl;
+            }
+        }
+    }
+
     if (unmatched.size() > 0) {
         // obtain the list of files
         std::vector<fs::path> files;
@@ -346,25 +804,109 @@ main(int argc, char **argv)
         for (auto &cp : files) {
             std::string filename = cp.filename().string();
             std::cout << filename << ": " << std::flush;
-            io::filtering_istream in;
-            if (boost::algorithm::ends_with(filename, ".bz2")) in.push(io::bzip2_decompressor());
-            if (boost::algorithm::ends_with(filename, ".gz")) in.push(io::gzip_decompressor());
-            std::ifstream inp(cp.c_str(), std::ios_base::binary);
-            in.push(inp);
             try {
-                Game game = PGParser::parse_pgsolver_renumber(in, opt_loops);
-                inp.close();
+                Game game;
+                int initial = -1;  // the vertex of the initial state of an automaton
+                int expected = -1; // the expected winner of <initial>, if known
+                if (boost::algorithm::ends_with(filename, ".pgc.bz2") or boost::algorithm::ends_with(filename, ".pgc.gz")) {
+                    io::filtering_istream in;
+                    if (boost::algorithm::ends_with(filename, ".bz2")) in.push(io::bzip2_decompressor());
+                    if (boost::algorithm::ends_with(filename, ".gz")) in.push(io::gzip_decompressor());
+                    std::ifstream inp(cp.c_str(), std::ios_base::binary);
+                    in.push(inp);
+                    game = PGParser::parse_compact(in);
+                    inp.close();
+                } else if (boost::algorithm::ends_with(filename, ".bz2") or boost::algorithm::ends_with(filename, ".gz")) {
+                    decompressed_text text = decompress_file(cp.string());
+                    game = PGParser::parse_pgsolver_buffer(text.data != NULL ? text.data : "", text.size, opt_loops);
+                } else if (boost::algorithm::ends_with(filename, ".pgb")) {
+                    game = PGParser::parse_binary_file(cp.string());
+                } else if (boost::algorithm::ends_with(filename, ".pgc")) {
+                    std::ifstream inp(cp.c_str(), std::ios_base::binary);
+                    game = PGParser::parse_compact(inp);
+                } else if (boost::algorithm::ends_with(filename, ".hoa") or boost::algorithm::ends_with(filename, ".ehoa")) {
+                    std::ifstream inp(cp.c_str());
+                    game = PGParser::parse_ehoa(inp, &initial);
+                    // the expected winner of the initial state is in the file name
+                    if (filename.find("_unrealizable") != std::string::npos) expected = 1;
+                    else if (filename.find("_realizable") != std::string::npos) expected = 0;
+                    // sort now, to know where the initial state goes
+                    std::vector<int> mapping(game.vertexcount());
+                    game.sort(mapping.data());
+                    initial = std::find(mapping.begin(), mapping.end(), initial) - mapping.begin();
+                } else {
+                    game = PGParser::parse_pgsolver_file(cp.string(), opt_loops);
+                    if (opt_fused) {
+                        log.str("");
+                        if (test_fused(cp.string(), opt_trace == -1 ? log : std::cout) == 0) {
+                            std::cout << "\033[38;5;82mfused\033[m ";
+                        } else {
+                            final_res = 3;
+                            std::cout << "\033[38;5;196mfused\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                        }
+                    }
+                    if (opt_parser) {
+                        std::ifstream inp(cp.c_str(), std::ios_base::binary);
+                        std::stringstream text;
+                        text << inp.rdbuf();
+                        log.str("");
+                        if (test_parser(text.str(), opt_trace == -1 ? log : std::cout) == 0) {
+                            std::cout << "\033[38;5;82mparser\033[m ";
+                        } else {
+                            final_res = 3;
+                            std::cout << "\033[38;5;196mparser\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                        }
+                    }
+                }
                 total++;
+                if (opt_roundtrip) {
+                    log.str("");
+                    if (test_roundtrip(game, opt_trace == -1 ? log : std::cout) == 0) {
+                        std::cout << "\033[38;5;82mroundtrip\033[m ";
+                    } else {
+                        final_res = 3;
+                        std::cout << "\033[38;5;196mroundtrip\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                    }
+                }
+                if (opt_wcwc_par) {
+                    log.str("");
+                    if (test_wcwc_parallel(game, opt_trace == -1 ? log : std::cout) == 0) {
+                        std::cout << "\033[38;5;82mwcwc\033[m ";
+                    } else {
+                        final_res = 3;
+                        std::cout << "\033[38;5;196mwcwc\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                    }
+                }
+                if (opt_reorder) {
+                    log.str("");
+                    if (test_reorder(game, opt_trace == -1 ? log : std::cout) == 0) {
+                        std::cout << "\033[38;5;82mreorder\033[m ";
+                    } else {
+                        final_res = 3;
+                        std::cout << "\033[38;5;196mreorder\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                    }
+                }
+                if (opt_flush_par) {
+                    log.str("");
+                    if (test_flush_parallel(game, opt_trace == -1 ? log : std::cout) == 0) {
+                        std::cout << "\033[38;5;82mflush\033[m ";
+                    } else {
+                        final_res = 3;
+                        std::cout << "\033[38;5;196mflush\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                    }
+                }
                 for (const auto& id : solvers) {
                     std::cout << std::flush;
                     log.str("");
                     int res = test_solver(game, id, time, opt_trace == -1 ? log : std::cout);
+                    if (res == 0 and expected != -1 and game.getWinner(initial) != expected) res = 4;
                     if (res == 0) {
                         sgood[id]++;
                         std::cout << "\033[38;5;82m" << id << "\033[m";
                     } else {
                         final_res = res;
                         std::cout << "\033[38;5;196m" << id << "\033[m";
+                        if (res == 4) std::cout << " (initial state has the wrong winner)";
                     }
                     std::cout << " \033[38;5;8m(" << std::fixed << std::setprecision(0) << (1000.0*time) << ")\033[m ";
                     times[id] += time;
@@ -373,9 +915,11 @@ main(int argc, char **argv)
             } catch (std::runtime_error &err) {
                 std::cout << err.what() << std::endl;
                 std::cout << "not a parity game input?!" << std::endl;
+                // files with the extension of a game format must be games
+                if (is_game_file(filename)) final_res = 3;
             }
         }
-    } else {
+    } else if (solvers.size() != 0 or opt_wcwc_par or opt_reorder or opt_flush_par or opt_parser) {
         // random
         uint64_t n = options["count"].as<int>();
         uint64_t size = options["size"].as<int>();
@@ -407,6 +951,50 @@ main(int argc, char **argv)
             std::cout << "game " << i << " (gameseed=" << seed << " size=" << g.vertexcount() << "," << g.edgecount() << "): ";
             std::cout << std::endl << std::flush;
             total++;
+            if (opt_wcwc_par) {
+                log.str("");
+                if (test_wcwc_parallel(g, opt_trace == -1 ? log : std::cout) == 0) {
+                    std::cout << "\033[38;5;82mwcwc\033[m ";
+                } else {
+                    final_res = 3;
+                    std::cout << "\033[38;5;196mwcwc\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+
+                    std::ostringstream fn;
+                    fn << "bad_wcwc_" << i << ".pg";
+                    std::ofstream fout(fn.str());
+                    g.write_pgsolver(fout);
+                    fout.close();
+                }
+            }
+            if (opt_reorder) {
+                log.str("");
+                if (test_reorder(g, opt_trace == -1 ? log : std::cout) == 0) {
+                    std::cout << "\033[38;5;82mreorder\033[m ";
+                } else {
+                    final_res = 3;
+                    std::cout << "\033[38;5;196mreorder\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                }
+            }
+            if (opt_parser) {
+                std::stringstream text;
+                g.write_pgsolver(text);
+                log.str("");
+                if (test_parser(text.str(), opt_trace == -1 ? log : std::cout) == 0) {
+                    std::cout << "\033[38;5;82mparser\033[m ";
+                } else {
+                    final_res = 3;
+                    std::cout << "\033[38;5;196mparser\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                }
+            }
+            if (opt_flush_par) {
+                log.str("");
+                if (test_flush_parallel(g, opt_trace == -1 ? log : std::cout) == 0) {
+                    std::cout << "\033[38;5;82mflush\033[m ";
+                } else {
+                    final_res = 3;
+                    std::cout << "\033[38;5;196mflush\033[m (" << log.str().substr(0, log.str().find('\n')) << ") ";
+                }
+            }
             for (const auto& id : solvers) {
                 std::cout << std::flush;
                 log.str("");